@@ -0,0 +1,181 @@
+/**
+ *  @file batcheval.h
+ *  @author Vincent Li
+ *  Scores many boards at once with the heuristic of evaluation.h, with SIMD on x86-64.
+ *  The kernels score a line of several boards at a time: count each mark's bits on the line in every lane,
+ *  then turn the counts into the line's score with compares instead of a lookup.
+ *  SSE2 scores 2 boards at a time and is always there on x86-64.  AVX2 scores 4, and is used if the CPU has it.
+ *  The 3x3 board is one lookup already, and Ultimate Tic Tac Toe is looked up by sub-board, so they are scored one at a time.
+ */
+
+#pragma once
+#ifndef BATCHEVAL
+#define BATCHEVAL
+
+#include "evaluation.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif  // defined(__x86_64__)
+
+// Kernels of evaluateBatch()
+const int BATCH_BEST = -1;  // The widest the CPU has
+const int BATCH_SCALAR = 0;
+const int BATCH_SSE2 = 1;
+const int BATCH_AVX2 = 2;
+const char* const BATCH_NAMES[] = {"scalar", "SSE2", "AVX2"};
+// Boards scored at once by the widest kernel
+const int BATCH_WIDTH = 4;
+
+/**
+ *  Returns the widest kernel the CPU has.
+ */
+inline int bestBatchKernel() {
+#if defined(__x86_64__)
+    static const int best = __builtin_cpu_supports("avx2") ? BATCH_AVX2 : BATCH_SSE2;
+    return best;
+#else
+    return BATCH_SCALAR;
+#endif  // defined(__x86_64__)
+}
+
+#if defined(__x86_64__)
+/**
+ *  Returns the number of set bits of each 64-bit lane, in the low bits of the lane.  SSE2 has no popcount, so bits are added in place.
+ */
+inline __m128i popcountLanes(__m128i v) {
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+    v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+    v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+    return _mm_sad_epu8(v, _mm_setzero_si128());
+}
+
+/**
+ *  Returns the line scores of lineScore() for the counts in each lane.
+ *  The counts fit in the low 32 bits of the 64-bit lanes, so 32-bit compares work, and the high halves score 0.
+ */
+inline __m128i lineScoreLanes(__m128i own, __m128i opp) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i three = _mm_set1_epi32(3);
+    // 1 for one mark alone, and 3 for more: 3 + 2 * (-1 if the count is 1)
+    __m128i ownOne = _mm_cmpeq_epi32(own, one);
+    __m128i oppOne = _mm_cmpeq_epi32(opp, one);
+    __m128i ownValue = _mm_add_epi32(three, _mm_add_epi32(ownOne, ownOne));
+    __m128i oppValue = _mm_add_epi32(three, _mm_add_epi32(oppOne, oppOne));
+    __m128i ownAlone = _mm_and_si128(_mm_cmpgt_epi32(own, zero), _mm_cmpeq_epi32(opp, zero));
+    __m128i oppAlone = _mm_and_si128(_mm_cmpgt_epi32(opp, zero), _mm_cmpeq_epi32(own, zero));
+    return _mm_sub_epi32(_mm_and_si128(ownAlone, ownValue), _mm_and_si128(oppAlone, oppValue));
+}
+
+/**
+ *  Score 2 boards at a time with SSE2.  @param n must be even.
+ */
+template<char Mark, int R, int C, int K>
+inline void evaluateBatchSSE2(const BitBoard<R, C, K>* boards, int n, int* scores) {
+    const char opponent = (Mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK;
+    for(int i = 0; i < n; i += 2) {
+        __m128i own = _mm_set_epi64x((int64_t)boards[i + 1].marks(Mark), (int64_t)boards[i].marks(Mark));
+        __m128i opp = _mm_set_epi64x((int64_t)boards[i + 1].marks(opponent), (int64_t)boards[i].marks(opponent));
+        __m128i h = _mm_setzero_si128();
+        for(auto line : BitBoard<R, C, K>::LINES) {
+            __m128i lines = _mm_set1_epi64x((int64_t)line);
+            h = _mm_add_epi32(h, lineScoreLanes(popcountLanes(_mm_and_si128(own, lines)), popcountLanes(_mm_and_si128(opp, lines))));
+        }
+        // The score of each board is the low 32 bits of its lane
+        scores[i] = _mm_cvtsi128_si32(h);
+        scores[i + 1] = _mm_cvtsi128_si32(_mm_srli_si128(h, 8));
+    }
+}
+
+/**
+ *  Returns the number of set bits of each 64-bit lane, from a lookup of each half byte.
+ */
+__attribute__((target("avx2")))
+inline __m256i popcountLanes(__m256i v) {
+    const __m256i nibbles = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(nibbles, _mm256_and_si256(v, low)),
+                                     _mm256_shuffle_epi8(nibbles, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+/**
+ *  Returns the line scores of lineScore() for the counts in each lane, like the SSE2 version.
+ */
+__attribute__((target("avx2")))
+inline __m256i lineScoreLanes(__m256i own, __m256i opp) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i three = _mm256_set1_epi32(3);
+    __m256i ownOne = _mm256_cmpeq_epi32(own, one);
+    __m256i oppOne = _mm256_cmpeq_epi32(opp, one);
+    __m256i ownValue = _mm256_add_epi32(three, _mm256_add_epi32(ownOne, ownOne));
+    __m256i oppValue = _mm256_add_epi32(three, _mm256_add_epi32(oppOne, oppOne));
+    __m256i ownAlone = _mm256_and_si256(_mm256_cmpgt_epi32(own, zero), _mm256_cmpeq_epi32(opp, zero));
+    __m256i oppAlone = _mm256_and_si256(_mm256_cmpgt_epi32(opp, zero), _mm256_cmpeq_epi32(own, zero));
+    return _mm256_sub_epi32(_mm256_and_si256(ownAlone, ownValue), _mm256_and_si256(oppAlone, oppValue));
+}
+
+/**
+ *  Score 4 boards at a time with AVX2.  @param n must be a multiple of 4.
+ */
+template<char Mark, int R, int C, int K>
+__attribute__((target("avx2")))
+inline void evaluateBatchAVX2(const BitBoard<R, C, K>* boards, int n, int* scores) {
+    const char opponent = (Mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK;
+    for(int i = 0; i < n; i += 4) {
+        __m256i own = _mm256_set_epi64x((int64_t)boards[i + 3].marks(Mark), (int64_t)boards[i + 2].marks(Mark),
+                                        (int64_t)boards[i + 1].marks(Mark), (int64_t)boards[i].marks(Mark));
+        __m256i opp = _mm256_set_epi64x((int64_t)boards[i + 3].marks(opponent), (int64_t)boards[i + 2].marks(opponent),
+                                        (int64_t)boards[i + 1].marks(opponent), (int64_t)boards[i].marks(opponent));
+        __m256i h = _mm256_setzero_si256();
+        for(auto line : BitBoard<R, C, K>::LINES) {
+            __m256i lines = _mm256_set1_epi64x((int64_t)line);
+            h = _mm256_add_epi32(h, lineScoreLanes(popcountLanes(_mm256_and_si256(own, lines)), popcountLanes(_mm256_and_si256(opp, lines))));
+        }
+        // The score of each board is the low 32 bits of its lane
+        scores[i] = _mm256_extract_epi32(h, 0);
+        scores[i + 1] = _mm256_extract_epi32(h, 2);
+        scores[i + 2] = _mm256_extract_epi32(h, 4);
+        scores[i + 3] = _mm256_extract_epi32(h, 6);
+    }
+}
+#endif  // defined(__x86_64__)
+
+/**
+ *  Score @param n boards into @param scores for the player with Mark, one at a time.
+ */
+template<char Mark, class Board>
+inline void evaluateBatch(const Board* boards, int n, int* scores, int kernel = BATCH_BEST) {
+    for(int i = 0; i < n; i++) scores[i] = evaluate<Mark>(boards[i]);
+}
+
+/**
+ *  Score @param n boards into @param scores for the player with Mark with the given BATCH_ kernel.
+ *  The boards left over from the kernel's width are scored one at a time.
+ */
+template<char Mark, int R, int C, int K>
+inline void evaluateBatch(const BitBoard<R, C, K>* boards, int n, int* scores, int kernel = BATCH_BEST) {
+    int done = 0;
+#if defined(__x86_64__)
+    if constexpr(!(R == 3 && C == 3 && K == 3)) {
+        if(kernel == BATCH_BEST) kernel = bestBatchKernel();
+        if(kernel == BATCH_AVX2) {
+            done = n & ~3;
+            evaluateBatchAVX2<Mark>(boards, done, scores);
+        }
+        else if(kernel == BATCH_SSE2) {
+            done = n & ~1;
+            evaluateBatchSSE2<Mark>(boards, done, scores);
+        }
+    }
+#endif  // defined(__x86_64__)
+    for(int i = done; i < n; i++) scores[i] = evaluate<Mark>(boards[i]);
+}
+
+#endif  // BATCHEVAL
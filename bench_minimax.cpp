@@ -0,0 +1,191 @@
+/**
+ *  @file bench_minimax.cpp
+ *  @author Vincent Li
+ *  Measures the speedup of the parallel minimax search over the serial one at each depth and thread count,
+ *  and the states and time of each search driver over the positions of a full game.
+ *  Also measures the leaves per second that each kernel of evaluateBatch() scores, and minimax with batched leaves.
+ *  Checks that every thread count and driver chooses the move of the serial alpha-beta search, and every kernel scores as the scalar one.
+ *  Usage: ./bench_minimax [max threads] [max depth]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "playerminimax.h"
+
+/**
+ *  Time one move of a new minimax player of the given depth and threads on @param game, so no table carries over.
+ *  Stores the move in @param move and returns the seconds it took.
+ */
+template<class Board>
+double timeMove(Game<Board>& game, int depth, int threads, moveRCPair& move) {
+    AIPlayerMinimax<Board> mm(game.currentPlayer, codeToMark(game.currentPlayer), depth);
+    mm.threads = threads;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    move = mm.chooseMove(&game);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ *  Add the rows of the scaling report of the given board, from @param game, to @param report.
+ *  Returns false if a thread count chose a different move than the serial search.
+ */
+template<class Board>
+bool scaling(const std::string& name, Game<Board>& game, int maxThreads, int maxDepth, std::ostringstream& report) {
+    bool same = true;
+    for(int depth = 1; depth <= maxDepth; depth++) {
+        moveRCPair serialMove;
+        double serial = timeMove(game, depth, 1, serialMove);
+        report << name << " depth " << depth << ": 1 thread " << serial * 1000 << " ms";
+        for(int threads = 2; threads <= maxThreads; threads *= 2) {
+            moveRCPair move;
+            double seconds = timeMove(game, depth, threads, move);
+            report << ", " << threads << " threads " << serial / seconds << "x";
+            if(move.row != serialMove.row || move.column != serialMove.column) {
+                report << " (chose " << move.row << ", " << move.column << " instead of " << serialMove.row << ", " << serialMove.column << ")";
+                same = false;
+            }
+        }
+        report << std::endl;
+    }
+    return same;
+}
+
+/**
+ *  Add the states searched and the time taken by each search driver over a full game of the given board to @param report.
+ *  The game is played by two alpha-beta players of the given depth, and players of each driver choose a move in each of its positions.
+ *  The last driver is alpha-beta with batched leaves.
+ *  Returns false if a driver chose a different move or value than alpha-beta.
+ */
+template<class Board>
+bool drivers(const std::string& name, int depth, std::ostringstream& report) {
+    const int numOfDrivers = 4;
+    const char* names[] = {"alpha-beta", "PVS", "MTD(f)", "batched alpha-beta"};
+    const int modes[] = {SEARCH_ALPHABETA, SEARCH_PVS, SEARCH_MTDF, SEARCH_ALPHABETA};
+
+    AIPlayerMinimax<Board>* players[numOfDrivers][2];
+    for(int d = 0; d < numOfDrivers; d++) {
+        players[d][0] = new AIPlayerMinimax<Board>(PLAYER_X_CODE, PLAYER_X_MARK, depth);
+        players[d][1] = new AIPlayerMinimax<Board>(PLAYER_O_CODE, PLAYER_O_MARK, depth);
+        players[d][0]->searchMode = players[d][1]->searchMode = modes[d];
+        players[d][0]->batchLeaves = players[d][1]->batchLeaves = (d == 3);
+    }
+    long states[numOfDrivers] = {0, 0, 0, 0};
+    double seconds[numOfDrivers] = {0, 0, 0, 0};
+    bool same = true;
+
+    Game<Board> game(Board(), PLAYER_X_CODE);
+    while(game.result == ONGOING) {
+        int side = (game.currentPlayer == PLAYER_X_CODE) ? 0 : 1;
+        moveRCPair move;
+        for(int d = 0; d < numOfDrivers; d++) {
+            AIPlayerMinimax<Board>* player = players[d][side];
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            moveRCPair chosen = player->chooseMove(&game);
+            seconds[d] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            states[d] += player->treeSize;
+            if(d == 0) move = chosen;
+            else if(chosen.row != move.row || chosen.column != move.column || player->lastValue != players[0][side]->lastValue) same = false;
+        }
+        game.makeMove(move.row, move.column);
+    }
+
+    report << name << " depth " << depth << ", " << game.turns << " moves:";
+    for(int d = 0; d < numOfDrivers; d++) {
+        report << " " << names[d] << " " << states[d] << " states " << seconds[d] * 1000 << " ms" << ((d < numOfDrivers - 1) ? "," : "");
+        delete players[d][0];
+        delete players[d][1];
+    }
+    report << std::endl;
+    return same;
+}
+
+/**
+ *  Add the leaves per second that each kernel of evaluateBatch() scores on random boards of the given size to @param report.
+ *  Boards get a random number of random marks, so their lines have every count.
+ *  Returns false if a kernel scored a board differently than the scalar one.
+ */
+template<class Board>
+bool leafThroughput(const std::string& name, std::ostringstream& report) {
+    const int numOfBoards = 4096;
+    std::vector<Board> boards(numOfBoards);
+    std::mt19937 random(Board::CELLS);
+    for(Board& board : boards) {
+        int marks = random() % Board::CELLS;
+        for(int i = 0; i < marks; i++) {
+            int cell = random() % Board::CELLS;
+            if(board.get(cell / Board::COLS, cell % Board::COLS) == CLEAR) {
+                board.set(cell / Board::COLS, cell % Board::COLS, (i % 2 == 0) ? PLAYER_X_MARK : PLAYER_O_MARK);
+            }
+        }
+    }
+
+    std::vector<int> expected(numOfBoards);
+    std::vector<int> scores(numOfBoards);
+    evaluateBatch<PLAYER_X_MARK>(boards.data(), numOfBoards, expected.data(), BATCH_SCALAR);
+    bool same = true;
+    report << name << ":";
+    for(int kernel = BATCH_SCALAR; kernel <= bestBatchKernel(); kernel++) {
+        // Repeat for at least 0.2 seconds
+        long leaves = 0;
+        double seconds = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while(seconds < 0.2) {
+            evaluateBatch<PLAYER_X_MARK>(boards.data(), numOfBoards, scores.data(), kernel);
+            leaves += numOfBoards;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        if(scores != expected) {
+            report << " (" << BATCH_NAMES[kernel] << " scored differently)";
+            same = false;
+        }
+        report << " " << BATCH_NAMES[kernel] << " " << leaves / seconds / 1e6 << "M leaves/s" << ((kernel < bestBatchKernel()) ? "," : "");
+    }
+    report << std::endl;
+    return same;
+}
+
+int main(int argc, char** argv) {
+    int cores = std::thread::hardware_concurrency();
+    int maxThreads = (argc > 1) ? std::stoi(argv[1]) : ((cores > 1) ? cores : 8);
+    int maxDepth = (argc > 2) ? std::stoi(argv[2]) : 4;
+    std::ostringstream report;
+
+    // After a few opening moves, so the roots have moves worth splitting
+    Game<Board4x4x3> board4x4(Board4x4x3(), PLAYER_X_CODE);
+    board4x4.makeMove(1, 1);
+    board4x4.makeMove(0, 0);
+    Game<Board5x5x4> board5x5(Board5x5x4(), PLAYER_X_CODE);
+    board5x5.makeMove(2, 2);
+    Game<UltimateBoard> ultimate(UltimateBoard(), PLAYER_X_CODE);
+    ultimate.makeMove(4, 4);
+    ultimate.makeMove(3, 3);
+
+    bool same = scaling("4x4 k=3", board4x4, maxThreads, maxDepth, report);
+    same = scaling("5x5 k=4", board5x5, maxThreads, maxDepth - 1, report) && same;
+    same = scaling("Ultimate", ultimate, maxThreads, maxDepth, report) && same;
+
+    std::ostringstream driverReport;
+    bool sameDrivers = drivers<Board4x4x3>("4x4 k=3", maxDepth, driverReport);
+    sameDrivers = drivers<Board5x5x4>("5x5 k=4", maxDepth - 1, driverReport) && sameDrivers;
+    sameDrivers = drivers<UltimateBoard>("Ultimate", maxDepth, driverReport) && sameDrivers;
+    same = same && sameDrivers;
+
+    std::ostringstream leafReport;
+    bool sameLeaves = leafThroughput<Board4x4x3>("4x4 k=3", leafReport);
+    sameLeaves = leafThroughput<Board5x5x4>("5x5 k=4", leafReport) && sameLeaves;
+    sameLeaves = leafThroughput<Board7x7x4>("7x7 k=4", leafReport) && sameLeaves;
+    sameLeaves = leafThroughput<Board7x7x5>("7x7 k=5", leafReport) && sameLeaves;
+    same = same && sameLeaves;
+
+    std::cout << std::endl << "Speedup over 1 thread, " << cores << " hardware threads" << std::endl << report.str();
+    std::cout << std::endl << "Search drivers over a full game" << std::endl << driverReport.str();
+    std::cout << std::endl << "Leaf evaluation by kernel" << std::endl << leafReport.str();
+    if(!same) std::cout << "Error: a parallel search or driver chose a different move than the serial alpha-beta search, or a kernel scored differently." << std::endl;
+    return same ? 0 : 1;
+}
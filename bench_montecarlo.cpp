@@ -0,0 +1,145 @@
+/**
+ *  @file bench_montecarlo.cpp
+ *  @author Vincent Li
+ *  Measures the Monte Carlo Tree Search player on each board: iterations per second from the empty board,
+ *  the nodes of the tree, and the memory of each node.
+ *  Then playouts per second with more playouts from each leaf, for the same playouts in all.
+ *  Then the scaling of root-parallel, shared-tree, and leaf-parallel search with threads: playouts per second of all threads,
+ *  and the score of each thread count in games against one thread of the same iterations.
+ *  Usage: ./bench_montecarlo [iterations] [games]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "playermontecarlo.h"
+
+// Returns the seconds since the given start.
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ *  Run one search of @param iterations from the empty board and print its speed and memory.
+ *  Forced moves are off so every board is searched.
+ */
+template<class Board>
+void benchSearch(const std::string& name, int iterations) {
+    Game<Board> game(Board(), PLAYER_X_CODE);
+    AIPlayerMonteCarlo<Board> player(PLAYER_X_CODE, PLAYER_X_MARK, iterations);
+    player.useThreats = false;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    player.search(&game);
+    double seconds = secondsSince(start);
+
+    size_t nodes = player.tree.size();
+    std::cout << name << ": " << (int)(iterations / seconds) << " iterations/s, " << nodes << " nodes, "
+              << sizeof(MonteCarloTreeNode<Board>) << " bytes/node, "
+              << (double)player.tree.memoryUsed() / nodes << " bytes/node with unused capacity" << std::endl;
+}
+
+/**
+ *  Run searches of @param playouts playouts from the empty board with 1, 4, 16, and 64 playouts from each leaf,
+ *  and print the playouts per second and nodes of each.
+ */
+template<class Board>
+void benchBatches(const std::string& name, int playouts) {
+    std::cout << name << ":" << std::endl;
+    for(int leafPlayouts = 1; leafPlayouts <= 64; leafPlayouts *= 4) {
+        Game<Board> game(Board(), PLAYER_X_CODE);
+        AIPlayerMonteCarlo<Board> player(PLAYER_X_CODE, PLAYER_X_MARK, playouts / leafPlayouts);
+        player.leafPlayouts = leafPlayouts;
+        player.useThreats = false;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        player.search(&game);
+        double seconds = secondsSince(start);
+
+        std::cout << "\t" << leafPlayouts << " playouts per leaf: " << (int)(playouts / seconds) << " playouts/s, "
+                  << player.tree.size() << " nodes" << std::endl;
+    }
+}
+
+/**
+ *  Play one game from the empty board between @param first and @param second, first moving first.
+ *  Returns the result.
+ */
+template<class Board>
+int playGame(AIPlayerMonteCarlo<Board>& first, AIPlayerMonteCarlo<Board>& second) {
+    Game<Board> game(Board(), first.code);
+    while(game.result == ONGOING) {
+        AIPlayerMonteCarlo<Board>& player = (game.currentPlayer == first.code) ? first : second;
+        moveRCPair move = player.chooseMove(&game);
+        game.makeMove(move.row, move.column);
+    }
+    return game.result;
+}
+
+/**
+ *  Print the playouts per second of each thread count from the empty board,
+ *  and its score, a win counting 1 and a draw 1/2, over @param games games against one thread, moving first in half of them.
+ *  Each thread plays out as many games as @param iterations, so a move takes as long with any number of threads on enough cores.
+ *  The threads search as @param parallelMode says.  With PARALLEL_LEAF, each plays one of the playouts from each leaf.
+ */
+template<class Board>
+void benchThreads(const std::string& name, int iterations, int games, int parallelMode) {
+    const char* modes[] = {"root-parallel", "shared tree", "leaf-parallel"};
+    std::cout << name << ", " << iterations << " playouts per thread, " << modes[parallelMode] << ":" << std::endl;
+    for(int threads = 1; threads <= 8; threads *= 2) {
+        Game<Board> game(Board(), PLAYER_X_CODE);
+        AIPlayerMonteCarlo<Board> player(PLAYER_X_CODE, PLAYER_X_MARK, iterations);
+        player.threads = threads;
+        player.parallelMode = parallelMode;
+        player.leafPlayouts = (parallelMode == PARALLEL_LEAF) ? threads : 1;
+        player.useThreats = false;
+        player.random.seed(threads);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        player.search(&game);
+        double seconds = secondsSince(start);
+
+        double score = 0;
+        for(int g = 0; g < games; g++) {
+            AIPlayerMonteCarlo<Board> parallel(PLAYER_X_CODE, PLAYER_X_MARK, iterations);
+            AIPlayerMonteCarlo<Board> serial(PLAYER_O_CODE, PLAYER_O_MARK, iterations);
+            parallel.threads = threads;
+            parallel.parallelMode = parallelMode;
+            parallel.leafPlayouts = player.leafPlayouts;
+            parallel.random.seed(2 * g);
+            serial.random.seed(2 * g + 1);
+            int result = (g % 2 == 0) ? playGame(parallel, serial) : playGame(serial, parallel);
+            if(result == PLAYER_X_WON) score += 1;
+            else if(result == DRAW) score += 0.5;
+        }
+
+        std::cout << "\t" << threads << " threads: " << (int)(threads * iterations / seconds) << " playouts/s, "
+                  << score << "/" << games << " against 1 thread" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    int iterations = (argc > 1) ? std::stoi(argv[1]) : 50000;
+    int games = (argc > 2) ? std::stoi(argv[2]) : 10;
+
+    std::cout << "Monte Carlo Tree Search, " << iterations << " iterations from the empty board" << std::endl;
+    benchSearch<TicTacToe>("3x3", iterations);
+    benchSearch<Board5x5x4>("5x5 k=4", iterations);
+    benchSearch<Board7x7x4>("7x7 k=4", iterations);
+    benchSearch<UltimateBoard>("Ultimate", iterations);
+
+    std::cout << "Playouts from each leaf, " << iterations << " playouts from the empty board" << std::endl;
+    benchBatches<Board5x5x4>("5x5 k=4", iterations);
+    benchBatches<Board7x7x4>("7x7 k=4", iterations);
+    benchBatches<UltimateBoard>("Ultimate", iterations);
+
+    std::cout << "Parallel Monte Carlo Tree Search on " << std::thread::hardware_concurrency() << " cores, "
+              << games << " games per thread count" << std::endl;
+    for(int parallelMode : {PARALLEL_ROOT, PARALLEL_TREE, PARALLEL_LEAF}) {
+        benchThreads<Board5x5x4>("5x5 k=4", iterations / 25, games, parallelMode);
+        benchThreads<UltimateBoard>("Ultimate", iterations / 25, games, parallelMode);
+    }
+
+    return 0;
+}
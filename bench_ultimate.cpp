@@ -0,0 +1,93 @@
+/**
+ *  @file bench_ultimate.cpp
+ *  @author Vincent Li
+ *  Measures random playouts per second of Ultimate Tic Tac Toe on the packed state and through Game,
+ *  and the speed of both AI players on it.
+ *  Usage: ./bench_ultimate [playouts]
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "playerminimax.h"
+#include "playermontecarlo.h"
+
+// Returns the seconds since the given start.
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ *  Play random moves on a copy of the packed state until the game ends.  Returns the result.
+ */
+int packedPlayout(UltimateBoard state, char mark) {
+    int result = terminalState(state);
+    while(result == ONGOING) {
+        UltimateBoard::MoveSet actions = getValidActions(state);
+        moveRCPair move = actions.nth(rand() % actions.size());
+        state.set(move.row, move.column, mark);
+        result = terminalState(state);
+        mark = (mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK;
+    }
+    return result;
+}
+
+/**
+ *  Play random moves through Game::makeMove() until the game ends.  Returns the result.
+ */
+int gamePlayout(Game<UltimateBoard>& game) {
+    while(game.result == ONGOING) {
+        UltimateBoard::MoveSet actions = getValidActions(game.board.state);
+        moveRCPair move = actions.nth(rand() % actions.size());
+        game.makeMove(move.row, move.column);
+    }
+    return game.result;
+}
+
+int main(int argc, char** argv) {
+    int playouts = (argc > 1) ? std::stoi(argv[1]) : 100000;
+    srand(time(NULL));
+
+    std::cout << "Ultimate Tic Tac Toe, " << playouts << " random playouts from the empty board" << std::endl;
+
+    // Packed state
+    int wins[3] = {0, 0, 0};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int i = 0; i < playouts; i++) wins[packedPlayout(UltimateBoard(), PLAYER_X_MARK) + 1]++;
+    double seconds = secondsSince(start);
+    std::cout << "Packed state:  " << playouts / seconds << " playouts/sec"
+              << " (X " << wins[2] << ", O " << wins[0] << ", draw " << wins[1] << ")" << std::endl;
+
+    // Game, with makeMove() keeping the history
+    Game<UltimateBoard> game(UltimateBoard(), PLAYER_X_CODE);
+    int moves = 0;
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < playouts; i++) {
+        game.setState(UltimateBoard(), PLAYER_X_CODE);
+        gamePlayout(game);
+        moves += game.turns;
+    }
+    seconds = secondsSince(start);
+    std::cout << "Game:          " << playouts / seconds << " playouts/sec, " << (double)moves / playouts << " moves each" << std::endl;
+
+    // Monte Carlo Tree Search from the empty board
+    int iterations = playouts / 10;
+    AIPlayerMonteCarlo<UltimateBoard> mc(PLAYER_X_CODE, PLAYER_X_MARK, iterations);
+    game.setState(UltimateBoard(), PLAYER_X_CODE);
+    start = std::chrono::steady_clock::now();
+    mc.chooseMove(&game);
+    seconds = secondsSince(start);
+    std::cout << "Monte Carlo:   " << iterations / seconds << " iterations/sec" << std::endl;
+
+    // Minimax in place, 2 moves ahead for each player
+    AIPlayerMinimax<UltimateBoard> mm(PLAYER_X_CODE, PLAYER_X_MARK, 2);
+    start = std::chrono::steady_clock::now();
+    mm.chooseMove(&game);
+    seconds = secondsSince(start);
+    std::cout << "Minimax:       " << mm.treeSize / seconds << " states/sec (" << mm.treeSize << " states)" << std::endl;
+
+    return 0;
+}
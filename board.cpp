@@ -6,13 +6,31 @@
 #include <iostream>
 #include <sstream>
 #include "board.h"
+#include "ultimate.h"
 
-std::string GameBoard::visBoard() {
+TicTacToe toBitBoard(const char grid[3][3]) {
+    TicTacToe board;
+
+    for(int r = 0; r < TicTacToe::ROWS; r++) {
+        for(int c = 0; c < TicTacToe::COLS; c++) {
+            if(grid[r][c] == PLAYER_X_MARK || grid[r][c] == PLAYER_O_MARK) board.set(r, c, grid[r][c]);
+        }
+    }
+
+    return board;
+}
+
+template<class Board>
+std::string GameBoard<Board>::visBoard() {
     std::stringstream ss;
-    ss << "   0  1  2\n"
-       << "0 [" << grid[0][0] << "][" << grid[0][1] << "][" << grid[0][2] << "]\n" 
-       << "1 [" << grid[1][0] << "][" << grid[1][1] << "][" << grid[1][2] << "]\n" 
-       << "2 [" << grid[2][0] << "][" << grid[2][1] << "][" << grid[2][2] << "]\n";
+    ss << " ";
+    for(int c = 0; c < Board::COLS; c++) ss << "  " << c;
+    ss << "\n";
+    for(int r = 0; r < Board::ROWS; r++) {
+        ss << r << " ";
+        for(int c = 0; c < Board::COLS; c++) ss << "[" << state.get(r, c) << "]";
+        ss << "\n";
+    }
 
     std::string display;
 
@@ -21,18 +39,22 @@ std::string GameBoard::visBoard() {
     return display;
 }
 
-bool GameBoard::set(int row, int col, char mark) {
+template<class Board>
+bool GameBoard<Board>::set(int row, int col, char mark) {
     bool status = true;
 
-    if(row > ROWS - 1 || col > COLS - 1 || row < 0 || col < 0) {
+    if(row > Board::ROWS - 1 || col > Board::COLS - 1 || row < 0 || col < 0) {
         status = false;
     }
-    else if(grid[row][col] != CLEAR) {
+    else if(state.get(row, col) != CLEAR) {
         status = false;
     }
     else {
-        grid[row][col] = mark;
+        state.set(row, col, mark);
     }
 
     return status;
-}
\ No newline at end of file
+}
+
+#define INSTANTIATE_BOARD(Board) template class GameBoard<Board>;
+FOR_EACH_GAME(INSTANTIATE_BOARD)
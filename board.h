@@ -1,21 +1,326 @@
 /**
  *  @file board.h
  *  @author Vincent Li
- *  This file implements the Tic Tac Toe board, specficially its configuration, 
- *  and functions that return the game state and status. 
+ *  This file implements the Tic Tac Toe board, specficially its configuration,
+ *  and functions that return the game state and status.
+ *  Boards are m x n with k in a row to win, and their line tables are built at compile time.
  */
 
 #pragma once
 #ifndef BOARD
 #define BOARD
 
+#include <stdint.h>
+#include <array>
 #include <string>
+#include <type_traits>
 #include "util.h"
 
+/**
+ *  The smallest unsigned integer type with a bit for each box.
+ */
+template<int CELLS>
+using MaskFor = typename std::conditional<(CELLS <= 16), uint16_t,
+                    typename std::conditional<(CELLS <= 32), uint32_t, uint64_t>::type>::type;
+
+/**
+ *  Number of rows, columns, and diagonals of length k on an m x n board.
+ */
+constexpr int numLines(int rows, int cols, int k) {
+    return rows * (cols - k + 1) + cols * (rows - k + 1) + 2 * (rows - k + 1) * (cols - k + 1);
+}
+
+// Steps between neighbouring boxes of a line: right, down, down-right, and down-left.
+constexpr int lineStep(int cols, int direction) {
+    return (direction == 0) ? 1 : ((direction == 1) ? cols : ((direction == 2) ? cols + 1 : cols - 1));
+}
+
+/**
+ *  Returns whether a line of length k can start at the given box and go in the given direction.
+ */
+constexpr bool lineFits(int rows, int cols, int k, int r, int c, int direction) {
+    bool fitsDown = (r + k <= rows);
+    bool fitsRight = (c + k <= cols);
+    bool fitsLeft = (c - k + 1 >= 0);
+    return (direction == 0) ? fitsRight : ((direction == 1) ? fitsDown : ((direction == 2) ? fitsDown && fitsRight : fitsDown && fitsLeft));
+}
+
+/**
+ *  Build the masks of every line of length k.
+ *  Rows come first, then columns, then diagonals, then anti-diagonals.
+ */
+template<int R, int C, int K>
+constexpr std::array<MaskFor<R * C>, numLines(R, C, K)> createLines() {
+    std::array<MaskFor<R * C>, numLines(R, C, K)> lines = {};
+    int l = 0;
+
+    for(int direction = 0; direction < 4; direction++) {
+        // Rows and diagonals are listed by their first box, columns by column first
+        for(int outer = 0; outer < ((direction == 1) ? C : R); outer++) {
+            for(int inner = 0; inner < ((direction == 1) ? R : C); inner++) {
+                int r = (direction == 1) ? inner : outer;
+                int c = (direction == 1) ? outer : inner;
+                if(!lineFits(R, C, K, r, c, direction)) continue;
+
+                MaskFor<R * C> line = 0;
+                for(int i = 0; i < K; i++) line |= MaskFor<R * C>(1) << (r * C + c + i * lineStep(C, direction));
+                lines[l++] = line;
+            }
+        }
+    }
+
+    return lines;
+}
+
+/**
+ *  Build, for each direction, the mask of the boxes where a line of length k can start.
+ */
+template<int R, int C, int K>
+constexpr std::array<MaskFor<R * C>, 4> createLineStarts() {
+    std::array<MaskFor<R * C>, 4> starts = {};
+
+    for(int direction = 0; direction < 4; direction++) {
+        for(int r = 0; r < R; r++) {
+            for(int c = 0; c < C; c++) {
+                if(lineFits(R, C, K, r, c, direction)) starts[direction] |= MaskFor<R * C>(1) << (r * C + c);
+            }
+        }
+    }
+
+    return starts;
+}
+
+/**
+ *  Build, for each box, the list of indices into the lines through it.
+ *  Each list is padded with the number of lines at index 0.
+ */
+template<int R, int C, int K>
+constexpr std::array<std::array<uint8_t, 4 * K + 1>, R * C> createCellLines() {
+    std::array<std::array<uint8_t, 4 * K + 1>, R * C> cellLines = {};
+    std::array<MaskFor<R * C>, numLines(R, C, K)> lines = createLines<R, C, K>();
+
+    for(int i = 0; i < R * C; i++) {
+        for(int l = 0; l < numLines(R, C, K); l++) {
+            if(lines[l] & (MaskFor<R * C>(1) << i)) cellLines[i][++cellLines[i][0]] = l;
+        }
+    }
+
+    return cellLines;
+}
+
+template<class Board> struct MaskMoveSet;
+template<int R, int C, int K> struct LineTracker;
+
+/**
+ *  A game state of an m x n board with k in a row to win, stored as one mask per player.
+ *  Bit toCell(row, col) of a mask is set if that player marked the box.
+ *  The geometry is fixed at compile time so each size gets its own line tables.
+ */
+template<int R, int C, int K>
+struct BitBoard {
+    static_assert(K >= 1 && K <= R && K <= C, "k must fit on the board");
+    static_assert(R * C <= 64, "boards must fit in a 64-bit mask");
+    static_assert(numLines(R, C, K) <= 256, "line indices must fit in a byte");
+
+    static constexpr int ROWS = R;
+    static constexpr int COLS = C;
+    static constexpr int IN_A_ROW = K;
+    static constexpr int CELLS = R * C;
+    static constexpr int NUM_LINES = numLines(R, C, K);
+    // Rotations and reflections, including the identity.  Only square boards can be transposed.
+    static constexpr int SYMMETRIES = (R == C) ? 8 : 4;
+
+    typedef MaskFor<R * C> Mask;
+    typedef MaskMoveSet<BitBoard> MoveSet;   // Set of moves returned by getValidActions()
+    typedef LineTracker<R, C, K> Tracker;    // Incremental state kept by Game for makeMove/undoMove
+
+    // Mask with a bit set for every box of the board.
+    static constexpr Mask FULL = (CELLS == 64) ? Mask(~Mask(0)) : Mask((uint64_t(1) << CELLS) - 1);
+    // Masks of every row, column, and diagonal of length k.
+    static constexpr std::array<Mask, NUM_LINES> LINES = createLines<R, C, K>();
+    // Boxes where a line can start, going right, down, down-right, and down-left.
+    static constexpr std::array<Mask, 4> LINE_STARTS = createLineStarts<R, C, K>();
+    // Indices into LINES of the lines through each box, after their count.
+    static constexpr std::array<std::array<uint8_t, 4 * K + 1>, CELLS> CELL_LINES = createCellLines<R, C, K>();
+
+    Mask x = 0;  // Boxes marked by Player X
+    Mask o = 0;  // Boxes marked by Player O
+
+    // Returns the bit index of the box in the given row and col.
+    static constexpr int toCell(int row, int col) { return row * COLS + col; }
+
+    // Returns the row and col of the box with the given bit index.
+    static constexpr moveRCPair toMove(int cell) { return std::make_pair(cell / COLS, cell % COLS); }
+
+    /**
+     *  Returns whether the mask contains k marks in a row.
+     *  Each direction takes k - 1 shifts, which the compiler unrolls for each size.
+     */
+    static bool hasLine(Mask marks) {
+        Mask runs = 0;
+        for(int direction = 0; direction < 4; direction++) {
+            Mask run = marks & LINE_STARTS[direction];
+            for(int i = 1; i < K; i++) run &= marks >> (i * lineStep(C, direction));
+            runs |= run;
+        }
+        return runs != 0;
+    }
+
+    // Returns the mask of the boxes with the given mark.
+    Mask marks(char mark) const { return (mark == PLAYER_X_MARK) ? x : o; }
+
+    // Returns the mask of the boxes that are marked by either player.
+    Mask occupied() const { return x | o; }
+
+    // Returns the mark in the given row and col, or CLEAR.
+    char get(int row, int col) const {
+        Mask bit = Mask(1) << toCell(row, col);
+        return (x & bit) ? PLAYER_X_MARK : ((o & bit) ? PLAYER_O_MARK : CLEAR);
+    }
+
+    // Marks the box in the given row and col.  Does not check if the box is clear.
+    void set(int row, int col, char mark) {
+        if(mark == PLAYER_X_MARK) x |= Mask(1) << toCell(row, col);
+        else o |= Mask(1) << toCell(row, col);
+    }
+
+    // Clears the box in the given row and col.
+    void clear(int row, int col) {
+        x &= ~(Mask(1) << toCell(row, col));
+        o &= ~(Mask(1) << toCell(row, col));
+    }
+
+    bool operator==(const BitBoard& other) const { return x == other.x && o == other.o; }
+    bool operator!=(const BitBoard& other) const { return !(*this == other); }
+};
+
+// The classic game, and the other sizes built into the play executable.
+typedef BitBoard<3, 3, 3> TicTacToe;
+typedef BitBoard<4, 4, 3> Board4x4x3;
+typedef BitBoard<4, 4, 4> Board4x4x4;
+typedef BitBoard<5, 5, 4> Board5x5x4;
+typedef BitBoard<5, 5, 5> Board5x5x5;
+typedef BitBoard<7, 7, 4> Board7x7x4;
+typedef BitBoard<7, 7, 5> Board7x7x5;
+
+/**
+ *  Calls MACRO with each board type that the templates are instantiated for.
+ */
+#define FOR_EACH_BOARD(MACRO) \
+    MACRO(TicTacToe) \
+    MACRO(Board4x4x3) \
+    MACRO(Board4x4x4) \
+    MACRO(Board5x5x4) \
+    MACRO(Board5x5x5) \
+    MACRO(Board7x7x4) \
+    MACRO(Board7x7x5)
+
+/**
+ *  A set of moves stored as a mask of boxes, so it lives on the stack instead of the heap.
+ *  Iterating it gives the moves in the order of the boxes' bit indices.
+ */
+template<class Board>
+struct MaskMoveSet {
+    typedef typename Board::Mask Mask;
+
+    Mask cells = 0;  // Bit Board::toCell(row, col) is set if the move is in the set
+
+    struct iterator {
+        Mask remaining;
+
+        moveRCPair operator*() const { return Board::toMove(lowestBit(remaining)); }
+        iterator& operator++() {
+            remaining &= remaining - 1;
+            return *this;
+        }
+        bool operator!=(const iterator& other) const { return remaining != other.remaining; }
+    };
+
+    iterator begin() const { return iterator{cells}; }
+    iterator end() const { return iterator{0}; }
+
+    int size() const { return countBits(cells); }
+    bool empty() const { return cells == 0; }
+    void clear() { cells = 0; }
+
+    // Returns whether the move in the given row and col is in the set.
+    bool contains(int row, int col) const { return (cells >> Board::toCell(row, col)) & 1; }
+
+    // Returns the move at the given index in iteration order.  @param index must be less than size().
+    moveRCPair nth(int index) const {
+        Mask remaining = cells;
+        for(int i = 0; i < index; i++) remaining &= remaining - 1;
+        return *iterator{remaining};
+    }
+};
+
+/**
+ *  The number of X's and O's on each line and the number of clear boxes of a board.
+ *  Game keeps one so a move only updates the lines through its box.
+ */
+template<int R, int C, int K>
+struct LineTracker {
+    typedef BitBoard<R, C, K> Board;
+
+    // Number of X's (index 0) and O's (index 1) on each of Board::LINES.
+    uint8_t lineCounts[2][Board::NUM_LINES] = {};
+    // Number of clear boxes.
+    int emptyCells = Board::CELLS;
+
+    // Recount the lines of the given game state.
+    void reset(const Board& state) {
+        for(int l = 0; l < Board::NUM_LINES; l++) {
+            lineCounts[0][l] = countBits(state.x & Board::LINES[l]);
+            lineCounts[1][l] = countBits(state.o & Board::LINES[l]);
+        }
+        emptyCells = Board::CELLS - countBits(state.occupied());
+    }
+
+    /**
+     *  Mark the box and return the game result that follows from @param result, the one before the move.
+     *  A win stands if a search plays on after it, and a double win counts for Player X like terminalState().
+     */
+    int add(Board& state, int row, int col, char mark, int result) {
+        int side = (mark == PLAYER_X_MARK) ? 0 : 1;
+        state.set(row, col, mark);
+
+        // Only the lines through this box can change
+        const std::array<uint8_t, 4 * K + 1>& lines = Board::CELL_LINES[Board::toCell(row, col)];
+        bool won = false;
+        for(int i = 1; i <= lines[0]; i++) {
+            if(++lineCounts[side][lines[i]] == K) won = true;
+        }
+        emptyCells--;
+
+        int code = (mark == PLAYER_X_MARK) ? PLAYER_X_CODE : PLAYER_O_CODE;
+        if(won && result != PLAYER_X_WON) result = code;
+        else if(result == ONGOING && emptyCells == 0) result = DRAW;
+
+        return result;
+    }
+
+    // Clear the box, which was marked with the given mark.
+    void remove(Board& state, int row, int col, char mark) {
+        int side = (mark == PLAYER_X_MARK) ? 0 : 1;
+
+        const std::array<uint8_t, 4 * K + 1>& lines = Board::CELL_LINES[Board::toCell(row, col)];
+        for(int i = 1; i <= lines[0]; i++) lineCounts[side][lines[i]]--;
+        emptyCells++;
+
+        state.clear(row, col);
+    }
+};
+
+/**
+ *  Create a TicTacToe board from a 3x3 array of X, O, and CLEAR marks.
+ */
+TicTacToe toBitBoard(const char grid[3][3]);
+
+template<class Board>
 class GameBoard {
     public:
-        // 2D array representing the board.
-        char grid[3][3] = BLANK_BOARD;
+        // Bitboard representing the board.
+        Board state;
 
         // Returns a string representation of the board.
         std::string visBoard();
@@ -24,8 +329,8 @@ class GameBoard {
          *  Place a marker on the board in the given row and col.
          *  Returns a bool for the status.  true: successful; false: failed/illegal.
          */
-        bool set(int row, int col, char mark);        
+        bool set(int row, int col, char mark);
 
 };
 
-#endif  // BOARD
\ No newline at end of file
+#endif  // BOARD
@@ -0,0 +1,144 @@
+/**
+ *  @file evaluation.h
+ *  @author Vincent Li
+ *  The line heuristic of AIPlayerMinimax, specialized at compile time for each board and side.
+ *  A line scores by its numbers of each mark, looked up in LINE_SCORES, and a whole 3x3 board by its base 3 index in BOARD_SCORES.
+ *  Scores are for the player with the template's Mark.
+ */
+
+#pragma once
+#ifndef EVALUATION
+#define EVALUATION
+
+#include <stdint.h>
+
+#include "util.h"
+#include "board.h"
+#include "game.h"
+#include "ultimate.h"
+
+/**
+ *  Returns the score of a line with the given numbers of own and opponent marks.
+ *  One mark alone scores 1, and two or more 3.  A line with both marks is blocked and scores 0.
+ */
+constexpr int lineScore(int own, int opp) {
+    if(own > 0 && opp == 0) return (own == 1) ? 1 : 3;
+    if(opp > 0 && own == 0) return (opp == 1) ? -1 : -3;
+    return 0;
+}
+
+// Score of a line of K boxes by its numbers of own and opponent marks
+template<int K>
+struct LineScores {
+    int8_t score[K + 1][K + 1];
+};
+
+template<int K>
+constexpr LineScores<K> createLineScores() {
+    LineScores<K> table = {};
+    for(int own = 0; own <= K; own++) {
+        for(int opp = 0; opp <= K; opp++) table.score[own][opp] = lineScore(own, opp);
+    }
+    return table;
+}
+
+template<int K>
+inline constexpr LineScores<K> LINE_SCORES = createLineScores<K>();
+
+// Score of every 3x3 board for Player X by its base 3 index, and the number of set bits of every 9-bit mask
+struct BoardScores {
+    int8_t score[TERNARY_BOARDS];
+    uint8_t bits[TicTacToe::FULL + 1];
+};
+
+/**
+ *  Build the BoardScores at compile time.  Player O's score of a board is the negation of Player X's.
+ */
+constexpr BoardScores createBoardScores() {
+    BoardScores table = {};
+
+    for(int mask = 0; mask <= TicTacToe::FULL; mask++) {
+        for(int i = 0; i < 9; i++) table.bits[mask] += (mask >> i) & 1;
+    }
+
+    for(int index = 0; index < TERNARY_BOARDS; index++) {
+        uint16_t x = 0;
+        uint16_t o = 0;
+        int digits = index;
+        for(int i = 0; i < 9; i++) {
+            if(digits % 3 == 1) x |= 1 << i;
+            else if(digits % 3 == 2) o |= 1 << i;
+            digits /= 3;
+        }
+
+        int score = 0;
+        for(uint16_t line : TicTacToe::LINES) score += lineScore(table.bits[x & line], table.bits[o & line]);
+        table.score[index] = score;
+    }
+
+    return table;
+}
+
+inline constexpr BoardScores BOARD_SCORES = createBoardScores();
+
+/**
+ *  Returns the line heuristic of the board for the player with Mark.
+ *  The 3x3 board is one lookup.  Larger boards look up each line by the bits of each mark on it.
+ */
+template<char Mark, int R, int C, int K>
+inline int evaluate(const BitBoard<R, C, K>& board) {
+    if constexpr(R == 3 && C == 3 && K == 3) {
+        int score = BOARD_SCORES.score[ternaryIndex(board)];
+        return (Mark == PLAYER_X_MARK) ? score : -1 * score;
+    }
+    else {
+        typedef typename BitBoard<R, C, K>::Mask Mask;
+        Mask own = (Mark == PLAYER_X_MARK) ? board.x : board.o;
+        Mask opp = (Mark == PLAYER_X_MARK) ? board.o : board.x;
+        int h = 0;
+        for(Mask line : BitBoard<R, C, K>::LINES) h += LINE_SCORES<K>.score[countBits(own & line)][countBits(opp & line)];
+        return h;
+    }
+}
+
+/**
+ *  Returns the line heuristic of a board from the line counts that Game keeps, for the player with Mark.
+ *  Each line is two counts and a lookup, with no bits to count.
+ */
+template<char Mark, int R, int C, int K>
+inline int evaluate(const LineTracker<R, C, K>& tracker) {
+    const uint8_t* own = tracker.lineCounts[(Mark == PLAYER_X_MARK) ? 0 : 1];
+    const uint8_t* opp = tracker.lineCounts[(Mark == PLAYER_X_MARK) ? 1 : 0];
+    int h = 0;
+    for(int l = 0; l < BitBoard<R, C, K>::NUM_LINES; l++) h += LINE_SCORES<K>.score[own[l]][opp[l]];
+    return h;
+}
+
+/**
+ *  Returns 9 * (the heuristic of the meta-board) + the heuristics of the open sub-boards, for the player with Mark.
+ *  A drawn sub-board blocks the lines of the meta-board through it.
+ *  A won game scores past any heuristic.
+ */
+template<char Mark>
+inline int evaluate(const UltimateBoard& board) {
+    int result = terminalState(board);
+    if(result == PLAYER_X_WON || result == PLAYER_O_WON) {
+        return (codeToMark(result) == Mark) ? 500 : -500;
+    }
+
+    uint16_t ownWon = ((Mark == PLAYER_X_MARK) ? board.wonX : board.wonO) | board.drawn;
+    uint16_t oppWon = ((Mark == PLAYER_X_MARK) ? board.wonO : board.wonX) | board.drawn;
+    int meta = 0;
+    for(uint16_t line : TicTacToe::LINES) meta += LINE_SCORES<3>.score[BOARD_SCORES.bits[ownWon & line]][BOARD_SCORES.bits[oppWon & line]];
+
+    int h = 0;
+    uint16_t open = ~board.decided() & SUBBOARD_MASK;
+    for(; open != 0; open &= open - 1) {
+        int s = lowestBit(open);
+        h += BOARD_SCORES.score[ternaryIndex(UltimateBoard::subBoard(board.x, s), UltimateBoard::subBoard(board.o, s))];
+    }
+
+    return 9 * meta + ((Mark == PLAYER_X_MARK) ? h : -1 * h);
+}
+
+#endif  // EVALUATION
@@ -10,75 +10,100 @@
 #endif  // defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
 
 #include "game.h"
+#include "player.h"
 
-Game::Game() {
-    // Initialize currentPlayer
-    srand(time(NULL));
+template<class Board>
+Game<Board>::Game() {
+    // Initialize currentPlayer.  The caller seeds rand(), so a game can be replayed.
     currentPlayer = ((rand() % 10) % 2 == 0) ? PLAYER_O_CODE : PLAYER_X_CODE;  // Randomly pick -1 or 1
+    boardHashes[0] = zobristBoardHash(board.state);
 }
 
-bool playerWins(const char playerMark, char grid[3][3]) {
-    bool won = false;
+template<class Board>
+Game<Board>::Game(const Board& state, int currentPlayer) {
+    setState(state, currentPlayer);
+}
 
-    // check horizontal
-    if((playerMark == grid[0][0] && playerMark == grid[0][1] && playerMark == grid[0][2])
-        || (playerMark == grid[1][0] && playerMark == grid[1][1] && playerMark == grid[1][2])
-        || (playerMark == grid[2][0] && playerMark == grid[2][1] && playerMark == grid[2][2])) {
-        won = true;
-    }
-    // check vertical
-    else if((playerMark == grid[0][0] && playerMark == grid[1][0] && playerMark == grid[2][0])
-        || (playerMark == grid[0][1] && playerMark == grid[1][1] && playerMark == grid[2][1])
-        || (playerMark == grid[0][2] && playerMark == grid[1][2] && playerMark == grid[2][2])) {
-        won = true;    
-        
-    }
-    // check diagnol
-    else if((playerMark == grid[0][0] && playerMark == grid[1][1] && playerMark == grid[2][2])
-        || (playerMark == grid[2][0] && playerMark == grid[1][1] && playerMark == grid[0][2])) {
-        won = true;
-    }
+template<class Board>
+void Game<Board>::setState(const Board& state, int currentPlayer) {
+    board.state = state;
+    this->currentPlayer = currentPlayer;
+    turns = 0;
+    history.clear();
+
+    tracker.reset(state);
+    result = terminalState(state);
+    boardHashes[0] = zobristBoardHash(state);
+    for(int t = 1; t < hashedSymmetries; t++) boardHashes[t] = zobristBoardHash(transformBoard(state, t));
+}
 
-    return won;
+template<class Board>
+void Game<Board>::hashSymmetries(bool on) {
+    hashedSymmetries = (on) ? Board::SYMMETRIES : 1;
+    for(int t = 1; t < hashedSymmetries; t++) boardHashes[t] = zobristBoardHash(transformBoard(board.state, t));
 }
 
-bool isDraw(char grid[3][3]) {
-    bool draw = false;
+template<class Board>
+int Game<Board>::makeMove(int row, int col) {
+    // Only the lines through this box are recounted
+    for(int t = 0; t < hashedSymmetries; t++) boardHashes[t] ^= zobristExtra(board.state, t);
+    result = tracker.add(board.state, row, col, codeToMark(currentPlayer), result);
+    updateHashes(Board::toCell(row, col), codeToMark(currentPlayer));
 
-    int markCount = 0;
+    history.push_back(std::make_pair(row, col));
+    currentPlayer = -1 * currentPlayer;
+    turns++;
 
-    for(int r = 0; r < ROWS; r++) {
-        for(int c = 0; c < COLS; c++) {
-            if(grid[r][c] != CLEAR) markCount++;
-        }
-    }
+    return result;
+}
 
-    if(markCount == ROWS * COLS) draw = true;
+template<class Board>
+void Game<Board>::undoMove() {
+    moveRCPair move = history.back();
+    history.pop_back();
+    currentPlayer = -1 * currentPlayer;
+    turns--;
 
-    return draw;
-}
+    for(int t = 0; t < hashedSymmetries; t++) boardHashes[t] ^= zobristExtra(board.state, t);
+    tracker.remove(board.state, move.row, move.column, codeToMark(currentPlayer));
+    updateHashes(Board::toCell(move.row, move.column), codeToMark(currentPlayer));
 
-bool Game::playerMarks(const char playerMark, int row, int col) {
-    bool status = board.set(row, col, playerMark);
+    // Searches may have played on after a win, so look the result up
+    result = terminalState(board.state);
+}
 
-    if(status == true) {
-        // add to history
-        moveRCPair move;
-        move.row = row;
-        move.column = col;
-        history.push_back(move);
+template<class Board>
+void Game<Board>::updateHashes(int cell, char mark) {
+    // The box moves to another box under each symmetry
+    for(int t = 0; t < hashedSymmetries; t++) {
+        boardHashes[t] ^= zobristKey(mark, SYMMETRY_TABLE<Board>.cells[t][cell]) ^ zobristExtra(board.state, t);
+    }
+}
 
-        // update current player
-        currentPlayer = -1 * currentPlayer;
+template<class Board>
+bool Game<Board>::playerMarks(const char playerMark, int row, int col) {
+    bool status = true;
 
-        // update turns
-        turns++;
+    if(row > Board::ROWS - 1 || col > Board::COLS - 1 || row < 0 || col < 0) {
+        status = false;
+    }
+    else if(board.state.get(row, col) != CLEAR || playerMark != codeToMark(currentPlayer)) {
+        status = false;
+    }
+    else if(!getValidActions(board.state).contains(row, col)) {
+        // The rules of the game do not allow the move, like a sub-board other than the forced one
+        status = false;
+    }
+    else {
+        // Updates history, current player, and turns
+        makeMove(row, col);
     }
 
     return status;
 }
 
-int Game::validatePlayerInput(std::string input) {
+template<class Board>
+int Game<Board>::validatePlayerInput(std::string input) {
     std::string inputCopy = input;
     int status = 0;
 
@@ -109,18 +134,22 @@ int Game::validatePlayerInput(std::string input) {
         // 0b1 means no ',' given
         status |= 0b1;
     }
-    if(r.empty() || rVal < 0 || rVal >= ROWS) {
+    if(r.empty() || rVal < 0 || rVal >= Board::ROWS) {
         // 0b10 means row value is invalid
         status |= 0b10;
     }
-    if(c.empty() || cVal < 0 || cVal >= COLS) {
+    if(c.empty() || cVal < 0 || cVal >= Board::COLS) {
         // 0b100 means col value is invalid
         status |= 0b100;
     }
-    if(cVal >= 0 && cVal < COLS && rVal >= 0 && rVal < ROWS && board.grid[rVal][cVal] != CLEAR) {
+    if(cVal >= 0 && cVal < Board::COLS && rVal >= 0 && rVal < Board::ROWS && board.state.get(rVal, cVal) != CLEAR) {
         // 0b1000 means the grid slot is already taken
         status |= 0b1000;
     }
+    else if(cVal >= 0 && cVal < Board::COLS && rVal >= 0 && rVal < Board::ROWS && !getValidActions(board.state).contains(rVal, cVal)) {
+        // 0b10000 means the rules do not allow a move there
+        status |= 0b10000;
+    }
 
     // notify
     if(status != 0) {
@@ -131,15 +160,21 @@ int Game::validatePlayerInput(std::string input) {
             std::cout << "\tMissing ','" << std::endl;
         }
         if((status & 0b10) == 0b10) {
-            std::cout << "\tRow value must be in [0, " << ROWS << ")" << std::endl;
+            std::cout << "\tRow value must be in [0, " << Board::ROWS << ")" << std::endl;
         }
         if((status & 0b100) == 0b100) {
-            std::cout << "\tCol value must be in [0, " << COLS << ")" << std::endl;
+            std::cout << "\tCol value must be in [0, " << Board::COLS << ")" << std::endl;
         }
         if((status & 0b1000) == 0b1000) {
             std::cout << "\tThe grid spot is already marked" << std::endl;
         }
+        if((status & 0b10000) == 0b10000) {
+            std::cout << "\tThe rules do not allow a move there" << std::endl;
+        }
 #endif  // #if defined(VERBOSE) || defined(DEBUG)
     }
     return status;
-}
\ No newline at end of file
+}
+
+#define INSTANTIATE_GAME(Board) template class Game<Board>;
+FOR_EACH_GAME(INSTANTIATE_GAME)
@@ -2,38 +2,145 @@
  *  @file game.h
  *  @author Vincent Li
  *  The Game class manages the game board on behalf of the players.
+ *  Games are templated on the board type, so each size gets its own rules.
  */
 
 #pragma once
 #ifndef GAME
 #define GAME
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
 #include <vector>
 
 #include "util.h"
 #include "board.h"
+#include "zobrist.h"
+#include "symmetry.h"
+
+// Number of possible boards when each box is X, O, or CLEAR (3^9).
+const int TERNARY_BOARDS = 19683;
+
+/**
+ *  Lookup tables for the result of every board.
+ *  A board's index is the base 3 number whose digit for each box is 0 (CLEAR), 1 (X), or 2 (O).
+ */
+struct TerminalTable {
+    // Base 3 value of each 9-bit mask with all set digits equal to 1.
+    uint16_t ternary[TicTacToe::FULL + 1];
+    // PLAYER_X_WON, PLAYER_O_WON, DRAW, or ONGOING for each base 3 index.
+    int8_t result[TERNARY_BOARDS];
+};
+
+/**
+ *  Build the TerminalTable at compile time.
+ *  If both players have a line, the board is counted as won by Player X.
+ */
+constexpr TerminalTable createTerminalTable() {
+    TerminalTable table = {};
+
+    for(int mask = 0; mask <= TicTacToe::FULL; mask++) {
+        int value = 0;
+        for(int i = 8; i >= 0; i--) value = value * 3 + ((mask >> i) & 1);
+        table.ternary[mask] = value;
+    }
+
+    for(int index = 0; index < TERNARY_BOARDS; index++) {
+        uint16_t x = 0;
+        uint16_t o = 0;
+        int digits = index;
+        for(int i = 0; i < 9; i++) {
+            if(digits % 3 == 1) x |= 1 << i;
+            else if(digits % 3 == 2) o |= 1 << i;
+            digits /= 3;
+        }
+
+        bool xWon = false;
+        bool oWon = false;
+        for(uint16_t line : TicTacToe::LINES) {
+            xWon = xWon || (x & line) == line;
+            oWon = oWon || (o & line) == line;
+        }
+
+        if(xWon) table.result[index] = PLAYER_X_WON;
+        else if(oWon) table.result[index] = PLAYER_O_WON;
+        else if((x | o) == TicTacToe::FULL) table.result[index] = DRAW;
+        else table.result[index] = ONGOING;
+    }
+
+    return table;
+}
+
+inline constexpr TerminalTable TERMINAL_TABLE = createTerminalTable();
+
+/**
+ *  Return the base 3 index into TERMINAL_TABLE of the 3x3 board with the given masks of X's and O's.
+ */
+inline int ternaryIndex(uint16_t x, uint16_t o) {
+    return TERMINAL_TABLE.ternary[x] + 2 * TERMINAL_TABLE.ternary[o];
+}
+
+/**
+ *  Return the base 3 index of the board into TERMINAL_TABLE.
+ */
+inline int ternaryIndex(const TicTacToe& board) {
+    return ternaryIndex(board.x, board.o);
+}
 
 /**
  *  Scan the board to determine if Player X/O won.
  *  Return true if so, false if not.
  */
-bool playerWins(const char playerMark, char grid[3][3]);
+template<int R, int C, int K>
+inline bool playerWins(const char playerMark, const BitBoard<R, C, K>& board) {
+    return BitBoard<R, C, K>::hasLine(board.marks(playerMark));
+}
 
 /**
  *  Scan the board to determine if there is a draw.
  *  Should call this after calling playerWins() for both players.
  *  Return true if so, false if not.
  */
-bool isDraw(char grid[3][3]);
+template<int R, int C, int K>
+inline bool isDraw(const BitBoard<R, C, K>& board) {
+    return board.occupied() == BitBoard<R, C, K>::FULL;
+}
+
+/**
+ *  Determine whether the board is won by Player X/O, a draw, or still being played.
+ *  The 3x3 board is looked up in TERMINAL_TABLE.  Larger boards test their masks for k in a row.
+ *  Return PLAYER_X_WON, PLAYER_O_WON, DRAW, or ONGOING.
+ */
+template<int R, int C, int K>
+inline int terminalState(const BitBoard<R, C, K>& board) {
+    if constexpr(R == 3 && C == 3 && K == 3) {
+        return TERMINAL_TABLE.result[ternaryIndex(board)];
+    }
+    else {
+        if(playerWins(PLAYER_X_MARK, board)) return PLAYER_X_WON;
+        else if(playerWins(PLAYER_O_MARK, board)) return PLAYER_O_WON;
+        else if(isDraw(board)) return DRAW;
+        else return ONGOING;
+    }
+}
 
+template<class Board>
 class Game {
     public:
-        GameBoard board;
+        GameBoard<Board> board;
         int currentPlayer = -1;  // code for current player.  Initial value determines the player that goes first.
         int turns = 0;  // number of turns taken / boxes filled
         std::vector<moveRCPair> history;  // vector of moves
+
+        // Line counts and clear boxes, updated by each move.
+        typename Board::Tracker tracker;
+        // PLAYER_X_WON, PLAYER_O_WON, DRAW, or ONGOING after the last move.
+        int result = ONGOING;
+        // Zobrist hash of the board under each symmetry, without the player to move, updated by each move.
+        // Only the first hashedSymmetries are kept: the board itself unless hashSymmetries() turns the rest on.
+        uint64_t boardHashes[Board::SYMMETRIES] = {};
+        int hashedSymmetries = 1;
         
         /**
          *  Constructor
@@ -41,6 +148,62 @@ class Game {
          */
         Game();
 
+        /**
+         *  Constructor for searching from the given game state.
+         *  @param currentPlayer is the code of the player to move.
+         */
+        Game(const Board& state, int currentPlayer);
+
+        /**
+         *  Replace the board with the given game state and recount the lines.
+         *  History and turns are cleared.
+         */
+        void setState(const Board& state, int currentPlayer);
+
+        /**
+         *  The current player marks the given row and col in place.
+         *  The move is not validated, so searches can keep playing after a win.
+         *  Updates the line counts through the box and the hashes, and returns the new result.
+         */
+        int makeMove(int row, int col);
+
+        /**
+         *  Take back the last move in history.
+         */
+        void undoMove();
+
+        /**
+         *  Keep the hashes of every symmetry of the board if @param on, for searches that look up canonical positions,
+         *  or of the board itself only, so playouts and other searches do not pay for the rest.
+         */
+        void hashSymmetries(bool on);
+
+        /**
+         *  Toggle the given mark in the box with the given bit index in each board hash,
+         *  and add the keys of the rest of the state after the move.
+         */
+        void updateHashes(int cell, char mark);
+
+        /**
+         *  Returns the Zobrist hash of the board under the given symmetry and the player to move.
+         *  Symmetries other than 0 need hashSymmetries().
+         */
+        uint64_t hash(int symmetry = 0) const {
+            return boardHashes[symmetry] ^ ((currentPlayer == PLAYER_O_CODE) ? ZOBRIST_KEYS.side : 0);
+        }
+
+        /**
+         *  Returns the symmetry that maps the board onto its canonical form, like canonicalSymmetry() without rehashing.
+         *  Without hashSymmetries(), the board is its own canonical form.
+         */
+        int canonicalSymmetry() const {
+            int canonical = 0;
+            for(int t = 1; t < hashedSymmetries; t++) {
+                if(boardHashes[t] < boardHashes[canonical]) canonical = t;
+            }
+            return canonical;
+        }
+
         /**
          *  Player makes a move with its given mark and grid row and col.
          *  Return true if successful, false otherwise.
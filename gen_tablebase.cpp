@@ -0,0 +1,27 @@
+/**
+ *  @file gen_tablebase.cpp
+ *  @author Vincent Li
+ *  Solves the 3x3 game and writes its perfect-play tablebase for AIPlayerTablebase and the -tablebase option of play.
+ *  Usage: ./gen_tablebase [file]  (default tictactoe.tb)
+ */
+
+#include <iostream>
+#include <string>
+
+#include "tablebase.h"
+
+int main(int argc, char** argv) {
+    std::string path = (argc > 1) ? argv[1] : "tictactoe.tb";
+
+    std::vector<TablebaseEntry> entries = createTablebase();
+    if(!writeTablebase(path, entries)) {
+        std::cout << "Error: could not write " << path << std::endl;
+        return 1;
+    }
+
+    int positions = 0;
+    for(const TablebaseEntry& entry : entries) positions += (entry.distance != UNREACHABLE);
+    std::cout << "Wrote " << positions << " positions to " << path << std::endl;
+
+    return 0;
+}
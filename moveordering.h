@@ -0,0 +1,194 @@
+/**
+ *  @file moveordering.h
+ *  @author Vincent Li
+ *  Move ordering for alpha-beta search.  The sooner the best move is searched, the more of the others are cut off.
+ *  Each heuristic can be turned on or off with the ORDER_ flags.
+ */
+
+#pragma once
+#ifndef MOVEORDERING
+#define MOVEORDERING
+
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+
+#include "util.h"
+#include "board.h"
+#include "ultimate.h"
+
+// Heuristics of MoveOrderer::moveOrdering
+const int ORDER_STATIC = 0b1;    // Boxes on more lines first, like the center, then corners, then edges
+const int ORDER_TACTICAL = 0b10; // Moves that win, then moves that block a win
+const int ORDER_KILLERS = 0b100; // Moves that caused a cutoff in another position at the same depth
+const int ORDER_HISTORY = 0b1000;// Moves that caused cutoffs anywhere in the search, weighted by the depth left
+const int ORDER_ALL = ORDER_STATIC | ORDER_TACTICAL | ORDER_KILLERS | ORDER_HISTORY;
+
+// History scores are halved when one passes this, so they fit under the killer and tactical scores.
+const int HISTORY_LIMIT = 1 << 19;
+
+/**
+ *  Returns the number of lines through the box with the given bit index.
+ */
+template<int R, int C, int K>
+inline int staticPrior(const BitBoard<R, C, K>& board, int cell) {
+    return BitBoard<R, C, K>::CELL_LINES[cell][0];
+}
+
+/**
+ *  Returns the number of lines through the box in its sub-board plus the number through the sub-board in the meta-board.
+ */
+inline int staticPrior(const UltimateBoard& board, int cell) {
+    return TicTacToe::CELL_LINES[cell % 9][0] + TicTacToe::CELL_LINES[cell / 9][0];
+}
+
+/**
+ *  Returns 2 if marking the box with the given bit index wins for @param mark, 1 if it blocks a win of @param opponentMark, or 0.
+ */
+template<int R, int C, int K>
+inline int tacticalScore(const BitBoard<R, C, K>& board, int cell, char mark, char opponentMark) {
+    typename BitBoard<R, C, K>::Mask bit = typename BitBoard<R, C, K>::Mask(1) << cell;
+    if(BitBoard<R, C, K>::hasLine(board.marks(mark) | bit)) return 2;
+    if(BitBoard<R, C, K>::hasLine(board.marks(opponentMark) | bit)) return 1;
+    return 0;
+}
+
+/**
+ *  Returns 2 if marking the box with the given bit index wins its sub-board for @param mark,
+ *  1 if it blocks @param opponentMark from winning the sub-board there, or 0.
+ */
+inline int tacticalScore(const UltimateBoard& board, int cell, char mark, char opponentMark) {
+    int s = cell / 9;
+    uint16_t bit = 1 << (cell % 9);
+    uint16_t own = UltimateBoard::subBoard(board.marks(mark), s);
+    uint16_t opp = UltimateBoard::subBoard(board.marks(opponentMark), s);
+    int ownCode = (mark == PLAYER_X_MARK) ? PLAYER_X_WON : PLAYER_O_WON;
+
+    // Only sub-boards that are still open count
+    if(board.decided() & (1 << s)) return 0;
+    int x = (mark == PLAYER_X_MARK) ? own | bit : opp;
+    int o = (mark == PLAYER_X_MARK) ? opp : own | bit;
+    if(TERMINAL_TABLE.result[ternaryIndex(x, o)] == ownCode) return 2;
+    x = (mark == PLAYER_X_MARK) ? own : opp | bit;
+    o = (mark == PLAYER_X_MARK) ? opp | bit : own;
+    if(TERMINAL_TABLE.result[ternaryIndex(x, o)] == -1 * ownCode) return 1;
+    return 0;
+}
+
+/**
+ *  Killer moves and history scores of a search, and counts of its cutoffs.
+ *  Killers are kept for each ply from the root, and history for each player and box.
+ */
+template<class Board>
+struct MoveOrderer {
+    // ORDER_ flags of the heuristics in use
+    int moveOrdering = ORDER_ALL;
+
+    // The last two moves that caused a cutoff at each ply, or -1
+    int8_t killers[Board::CELLS + 1][2];
+    // Cutoffs caused by each box, for Player X (index 0) and Player O (index 1)
+    int history[2][Board::CELLS];
+
+    // Nodes whose moves were searched, nodes cut off before their last move, and those cut off by their first move
+    long interiorNodes = 0;
+    long cutoffs = 0;
+    long firstMoveCutoffs = 0;
+
+    MoveOrderer() { clear(); }
+
+    // Forget the killers and history and reset the counts.
+    void clear() {
+        std::fill(&killers[0][0], &killers[0][0] + (Board::CELLS + 1) * 2, -1);
+        std::fill(&history[0][0], &history[0][0] + 2 * Board::CELLS, 0);
+        interiorNodes = 0;
+        cutoffs = 0;
+        firstMoveCutoffs = 0;
+    }
+
+    /**
+     *  Returns the score of marking the box with the given bit index at the given ply.  Higher scores are searched first.
+     *  Wins and blocks come before killers, and killers before history, which ties are broken by the static prior.
+     */
+    int score(const Board& state, int cell, char mark, char opponentMark, int ply) const {
+        int s = 0;
+        if(moveOrdering & ORDER_TACTICAL) s += tacticalScore(state, cell, mark, opponentMark) << 28;
+        if(moveOrdering & ORDER_KILLERS) {
+            if(killers[ply][0] == cell) s += 2 << 24;
+            else if(killers[ply][1] == cell) s += 1 << 24;
+        }
+        if(moveOrdering & ORDER_HISTORY) s += history[(mark == PLAYER_X_MARK) ? 0 : 1][cell] << 4;
+        if(moveOrdering & ORDER_STATIC) s += staticPrior(state, cell);
+        return s;
+    }
+
+    /**
+     *  Score each of the given moves into @param scores, for the player with @param mark to move at the given ply.
+     */
+    void scoreMoves(const Board& state, const moveRCPair* moves, int numOfMoves, char mark, char opponentMark, int ply, int* scores) const {
+        for(int i = 0; i < numOfMoves; i++) scores[i] = score(state, Board::toCell(moves[i].row, moves[i].column), mark, opponentMark, ply);
+    }
+
+    /**
+     *  Sort the items by their scores, highest first.  Equal scores keep their order.
+     *  Insertion sort, since there are few moves.
+     */
+    template<class T>
+    static void sortByScore(T* items, int* scores, int numOfItems) {
+        for(int i = 1; i < numOfItems; i++) {
+            T item = items[i];
+            int s = scores[i];
+            int j = i - 1;
+            for(; j >= 0 && scores[j] < s; j--) {
+                items[j + 1] = items[j];
+                scores[j + 1] = scores[j];
+            }
+            items[j + 1] = item;
+            scores[j + 1] = s;
+        }
+    }
+
+    /**
+     *  Forget the killers, whose plies are counted from the old root, and the counts before a new search.
+     *  History carries over at half weight.
+     */
+    void newSearch() {
+        std::fill(&killers[0][0], &killers[0][0] + (Board::CELLS + 1) * 2, -1);
+        for(int i = 0; i < 2 * Board::CELLS; i++) history[i / Board::CELLS][i % Board::CELLS] /= 2;
+        interiorNodes = 0;
+        cutoffs = 0;
+        firstMoveCutoffs = 0;
+    }
+
+    /**
+     *  Count a node whose moves were searched.  If it was cut off, @param index is the index of the move that did it,
+     *  which becomes a killer at the ply and gains history by the square of the depth left.
+     */
+    void record(int cell, char mark, int ply, int depth, bool cutoff, int index) {
+        interiorNodes++;
+        if(!cutoff) return;
+
+        cutoffs++;
+        if(index == 0) firstMoveCutoffs++;
+
+        if(killers[ply][0] != cell) {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = cell;
+        }
+
+        int side = (mark == PLAYER_X_MARK) ? 0 : 1;
+        history[side][cell] += depth * depth;
+        if(history[side][cell] > HISTORY_LIMIT) {
+            for(int i = 0; i < 2 * Board::CELLS; i++) history[i / Board::CELLS][i % Board::CELLS] /= 2;
+        }
+    }
+
+    /**
+     *  Returns the effective branching factor of a search of the given number of nodes to the given depth:
+     *  the number of successors per node that a uniform tree of that size and depth would have.
+     */
+    static double effectiveBranchingFactor(long nodes, int depth) {
+        return (depth <= 0) ? 0 : pow((double)nodes, 1.0 / depth);
+    }
+};
+
+#endif  // MOVEORDERING
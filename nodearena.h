@@ -0,0 +1,121 @@
+/**
+ *  @file nodearena.h
+ *  @author Vincent Li
+ *  An arena of tree nodes, allocated in large blocks instead of one at a time.
+ *  Nodes are found by their 32-bit index, and do not move as the arena grows.
+ *  A run of nodes allocated together is contiguous, so the successors of a node can be found from the first.
+ *  Trees are thrown away whole, so there is no freeing of single nodes: release() takes back every node at once
+ *  and keeps the blocks for the next tree, so a search only calls malloc while its tree is larger than any before it.
+ */
+
+#pragma once
+#ifndef NODEARENA
+#define NODEARENA
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<class T, int BlockBits = 12>
+class NodeArena {
+    static_assert(std::is_trivially_destructible<T>::value, "Released nodes are not destroyed one by one");
+
+    public:
+        // Nodes in each block.  A run of nodes can not be longer.
+        static const uint32_t BLOCK_NODES = 1 << BlockBits;
+
+        NodeArena() {}
+        NodeArena(const NodeArena&) = delete;
+        NodeArena& operator=(const NodeArena&) = delete;
+        ~NodeArena() { this->freeMemory(); }
+
+        T& operator[](uint32_t index) { return this->blocks[index >> BlockBits][index & (BLOCK_NODES - 1)]; }
+        const T& operator[](uint32_t index) const { return this->blocks[index >> BlockBits][index & (BLOCK_NODES - 1)]; }
+
+        /**
+         * Make sure the next @param n nodes allocated are in one block, so they are contiguous.
+         * The rest of the current block is skipped if they do not fit in it.
+         */
+        void reserveRun(uint32_t n) {
+            uint32_t offset = this->next & (BLOCK_NODES - 1);
+            if(offset != 0 && offset + n > BLOCK_NODES) this->next += BLOCK_NODES - offset;
+        }
+
+        /**
+         * Make room in the table of blocks for @param n more nodes, so no block is moved while threads read nodes
+         * as another allocates them.  The blocks themselves are allocated as they are needed.
+         */
+        void reserve(uint64_t n) {
+            // Every run may skip up to the rest of a block, so leave room for twice as many
+            this->blocks.reserve((this->next + 2 * n) / BLOCK_NODES + 2);
+        }
+
+        /**
+         * Allocate @param n value-initialized nodes in one block and return the index of the first.
+         */
+        uint32_t allocate(uint32_t n = 1) {
+            this->reserveRun(n);
+            uint32_t first = this->next;
+            uint32_t block = first >> BlockBits;
+            if(block == this->blocks.size()) {
+                T* memory = static_cast<T*>(malloc(BLOCK_NODES * sizeof(T)));
+                if(memory == NULL) throw std::bad_alloc();
+                this->blocks.push_back(memory);
+            }
+            T* nodes = &this->blocks[block][first & (BLOCK_NODES - 1)];
+            for(uint32_t i = 0; i < n; i++) new (nodes + i) T();
+
+            this->next += n;
+            this->liveNodes += n;
+            if(this->liveNodes > this->peakNodes) this->peakNodes = this->liveNodes;
+            return first;
+        }
+
+        /**
+         * Release every node at once.  The blocks are kept for the nodes allocated next.
+         */
+        void release() {
+            this->next = 0;
+            this->liveNodes = 0;
+        }
+
+        /**
+         * Release every node and give the blocks back to the system.
+         */
+        void freeMemory() {
+            for(T* block : this->blocks) free(block);
+            std::vector<T*>().swap(this->blocks);
+            this->release();
+        }
+
+        void swap(NodeArena& other) {
+            std::swap(this->blocks, other.blocks);
+            std::swap(this->next, other.next);
+            std::swap(this->liveNodes, other.liveNodes);
+            std::swap(this->peakNodes, other.peakNodes);
+        }
+
+        // Nodes allocated since the last release()
+        uint32_t live() const { return this->liveNodes; }
+
+        // The most nodes that were live at once
+        uint32_t peak() const { return this->peakNodes; }
+
+        // Number of blocks held, in use or not
+        size_t numOfBlocks() const { return this->blocks.size(); }
+
+        // Bytes held by the blocks
+        size_t memoryUsed() const { return this->blocks.size() * BLOCK_NODES * sizeof(T); }
+
+    private:
+        std::vector<T*> blocks;
+        // Index of the next node to allocate
+        uint32_t next = 0;
+        uint32_t liveNodes = 0;
+        uint32_t peakNodes = 0;
+};
+
+#endif  // NODEARENA
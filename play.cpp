@@ -12,20 +12,23 @@
 
 #include <algorithm>
 #include <vector>
+#include <ctype.h>
 #include <signal.h>
+#include <type_traits>
 
 #include "play.h"
 #include "game.h"
 
-int Play::play(Player& playerX, Player& playerO) {
+template<class Board>
+int Play::play(BoardPlayer<Board>& playerX, BoardPlayer<Board>& playerO, bool analyze) {
     int result;
-    Game game;
+    Game<Board> game;
     
     // game status
     int xWon = 0;
     int oWon = 0;
     int draw = 0;
-    Player* player;
+    BoardPlayer<Board>* player;
 #if defined(VERBOSE) || defined(DEBUG)
     std::cout << "Welcome to a game of Tic-Tac-Toe!" << std::endl;
 #endif  // defined(VERBOSE) || defined(DEBUG)
@@ -39,16 +42,17 @@ int Play::play(Player& playerX, Player& playerO) {
         // Notify whose turn it is
         std::cout << "Player " << player->mark << " goes: " << std::endl;
 #endif  // defined(VERBOSE) || defined(DEBUG)     
+        if(analyze) printAnalysis(player->mark, player->analyze(&game));
         // Get valid player input
         moveRCPair move = player->chooseMove(&game);
 
         // Make the move
         game.playerMarks(player->mark, move.row, move.column);
 
-        // Check game status
-        xWon = playerWins(playerX.mark, game.board.grid);
-        oWon = playerWins(playerO.mark, game.board.grid);
-        draw = isDraw(game.board.grid);
+        // Check game status, which the move updated from the lines through its box
+        xWon = (game.result == PLAYER_X_WON);
+        oWon = (game.result == PLAYER_O_WON);
+        draw = (game.result == DRAW);
     }
 
     if(xWon) {
@@ -82,6 +86,16 @@ int Play::play(Player& playerX, Player& playerO) {
     return result;
 }
 
+void printAnalysis(char mark, const std::vector<MoveAnalysis>& analysis) {
+    if(analysis.empty()) return;
+    std::cout << "Analysis for Player " << mark << ":" << std::endl;
+    for(const MoveAnalysis& entry : analysis) {
+        std::cout << "\t" << entry.move.row << "," << entry.move.column << "\tscore " << entry.score << "\tpv";
+        for(moveRCPair move : entry.pv) std::cout << " " << move.row << "," << move.column;
+        std::cout << std::endl;
+    }
+}
+
 void toExit(int sig) {
 #if defined(VERBOSE) || defined(DEBUG)
     std::cout << std::endl << "Program terminated" << std::endl;
@@ -91,50 +105,180 @@ void toExit(int sig) {
     exit(sig);
 }
 
-int main(int argc, char** argv) {
-    signal(SIGINT, toExit);
+template<class Board>
+BoardPlayer<Board>* createPlayer(int code, char mark, std::vector<std::string>::iterator typeLoc, std::vector<std::string>::iterator end, const Tablebase* tablebase, int threads, uint64_t seed) {
+    BoardPlayer<Board>* player = NULL;
+
+    if(typeLoc == end) {
+        // No player type given
+    }
+    else if(*typeLoc == "hp" || *typeLoc == "human") {
+        player = new HumanPlayer<Board>(code, mark);
+    }
+    else if(*typeLoc == "mm" || *typeLoc == "minimax") {
+        int depth = std::stoi(*(++typeLoc));
+        // The milliseconds per move are optional, so the next input may be another option
+        ++typeLoc;
+        int timeBudget = (typeLoc == end || !isdigit((*typeLoc)[0])) ? 0 : std::stoi(*typeLoc);
+        if(typeLoc != end && isdigit((*typeLoc)[0])) ++typeLoc;
+        // So is the search driver
+        int searchMode = SEARCH_ALPHABETA;
+        if(typeLoc != end && *typeLoc == "pvs") searchMode = SEARCH_PVS;
+        else if(typeLoc != end && *typeLoc == "mtdf") searchMode = SEARCH_MTDF;
+        if(typeLoc != end && (*typeLoc == "ab" || *typeLoc == "pvs" || *typeLoc == "mtdf")) ++typeLoc;
+        // And scoring the leaves in batches
+        bool batchLeaves = (typeLoc != end && *typeLoc == "batch");
+        AIPlayerMinimax<Board>* minimax = new AIPlayerMinimax<Board>(code, mark, depth, timeBudget);
+        minimax->searchMode = searchMode;
+        minimax->batchLeaves = batchLeaves;
+        minimax->tablebase = tablebase;
+        minimax->threads = threads;
+        player = minimax;
+    }
+    else if(*typeLoc == "mc" || *typeLoc == "montecarlo") {
+        AIPlayerMonteCarlo<Board>* monteCarlo = new AIPlayerMonteCarlo<Board>(code, mark, std::stoi(*(++typeLoc)));
+        // The playouts per leaf are optional, so the next input may be another option
+        ++typeLoc;
+        int leafPlayouts = (typeLoc == end || !isdigit((*typeLoc)[0])) ? 1 : std::stoi(*typeLoc);
+        if(typeLoc != end && isdigit((*typeLoc)[0])) ++typeLoc;
+        // A leaf gets at least one playout
+        monteCarlo->leafPlayouts = std::max(leafPlayouts, 1);
+        // So is the parallel search
+        if(typeLoc != end && *typeLoc == "tree") monteCarlo->parallelMode = PARALLEL_TREE;
+        else if(typeLoc != end && *typeLoc == "leaf") monteCarlo->parallelMode = PARALLEL_LEAF;
+        monteCarlo->tablebase = tablebase;
+        // Each player gets its own sequence from the game's seed
+        monteCarlo->random.seed(seed ^ mark);
+        monteCarlo->threads = threads;
+        player = monteCarlo;
+    }
+    else if(*typeLoc == "pn" || *typeLoc == "proofnumber") {
+        // The node limit is optional, so the next input may be another option
+        ++typeLoc;
+        long nodeLimit = (typeLoc == end || !isdigit((*typeLoc)[0])) ? 0 : std::stol(*typeLoc);
+        player = new AIPlayerProofNumber<Board>(code, mark, nodeLimit);
+    }
+    else if(*typeLoc == "tb" || *typeLoc == "tablebase") {
+        // Only the 3x3 game has a tablebase
+        if constexpr(std::is_same<Board, TicTacToe>::value) {
+            // The file is optional, so the next input may be another option
+            ++typeLoc;
+            AIPlayerTablebase* perfect = new AIPlayerTablebase(code, mark, (typeLoc == end || (*typeLoc)[0] == '-') ? "tictactoe.tb" : *typeLoc);
+            if(perfect->tablebase.isOpen()) player = perfect;
+            else {
+                std::cout << "Error: could not map the tablebase file.  Run ./gen_tablebase to create it." << std::endl;
+                delete perfect;
+            }
+        }
+    }
+
+    return player;
+}
 
+template<class Board>
+void runGame(std::vector<std::string>& inputs) {
     Play playGame;
 
+    std::vector<std::string>::iterator pOLoc = std::find(inputs.begin(), inputs.end(), "-pO");
+    std::vector<std::string>::iterator pXLoc = std::find(inputs.begin(), inputs.end(), "-pX");
+    std::vector<std::string>::iterator pOTypeLoc = (pOLoc == inputs.end()) ? pOLoc : ++pOLoc;
+    std::vector<std::string>::iterator pXTypeLoc = (pXLoc == inputs.end()) ? pXLoc : ++pXLoc;
+
+    // Tablebase for the AI players: -tablebase <file>
+    std::vector<std::string>::iterator tablebaseLoc = std::find(inputs.begin(), inputs.end(), "-tablebase");
+    Tablebase tablebase;
+    if(tablebaseLoc != inputs.end()) {
+        std::string path = (tablebaseLoc + 1 == inputs.end() || (*(tablebaseLoc + 1))[0] == '-') ? "tictactoe.tb" : *(tablebaseLoc + 1);
+        if(!std::is_same<Board, TicTacToe>::value) {
+            std::cout << "Error: only the 3x3 game has a tablebase." << std::endl;
+        }
+        else if(!tablebase.open(path)) {
+            std::cout << "Error: could not map the tablebase file " << path << ".  Run ./gen_tablebase to create it." << std::endl;
+        }
+    }
+    const Tablebase* aiTablebase = (tablebase.isOpen()) ? &tablebase : NULL;
+
+    // Print the scores of every move before each one: -analyze
+    bool analyze = std::find(inputs.begin(), inputs.end(), "-analyze") != inputs.end();
+
+    // Threads of each minimax and Monte Carlo player: -threads <n>
+    std::vector<std::string>::iterator threadsLoc = std::find(inputs.begin(), inputs.end(), "-threads");
+    int threads = (threadsLoc != inputs.end() && threadsLoc + 1 != inputs.end()) ? std::max(std::stoi(*(threadsLoc + 1)), 1) : 1;
+
+    // Seed of every random choice, so a game can be replayed: -seed <n>
+    std::vector<std::string>::iterator seedLoc = std::find(inputs.begin(), inputs.end(), "-seed");
+    uint64_t seed = (seedLoc != inputs.end() && seedLoc + 1 != inputs.end()) ? std::stoull(*(seedLoc + 1)) : clockSeed() % 1000000000;
+    srand(seed);
+#if defined(VERBOSE) || defined(DEBUG)
+    std::cout << "Seed: " << seed << std::endl;
+#endif  // defined(VERBOSE) || defined(DEBUG)
+
+    // Strict inputs
+    BoardPlayer<Board>* x = createPlayer<Board>(PLAYER_X_CODE, PLAYER_X_MARK, pXTypeLoc, inputs.end(), aiTablebase, threads, seed);
+    if(x == NULL) {
+        std::cout << "Error: Player X defined incorrectly." << std::endl;
+    }
+    BoardPlayer<Board>* o = createPlayer<Board>(PLAYER_O_CODE, PLAYER_O_MARK, pOTypeLoc, inputs.end(), aiTablebase, threads, seed);
+    if(o == NULL) {
+        std::cout << "Error: Player O defined incorrectly." << std::endl;
+    }
+
+    // Keep the players where toExit() can free them
+    playerX = x;
+    playerO = o;
+
+    if(x != NULL && o != NULL) {
+        playGame.play(*x, *o, analyze);
+    }
+
+    delete playerX;
+    delete playerO;
+}
+
+int main(int argc, char** argv) {
+    signal(SIGINT, toExit);
+
     // Run a game between two human players.
-    //HumanPlayer playerX = HumanPlayer(PLAYER_X_CODE, PLAYER_X_MARK);
-    //HumanPlayer playerO = HumanPlayer(PLAYER_O_CODE, PLAYER_O_MARK);
-    //playGame.play(playerX, playerO);
+    //HumanPlayer<TicTacToe> playerX = HumanPlayer<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK);
+    //HumanPlayer<TicTacToe> playerO = HumanPlayer<TicTacToe>(PLAYER_O_CODE, PLAYER_O_MARK);
+    //Play().play(playerX, playerO);
 
     // Run a game between a human and an AI player.
-    //HumanPlayer playerX = HumanPlayer(PLAYER_X_CODE, PLAYER_X_MARK);
-    //AIPlayerMinimax ai = AIPlayerMinimax(PLAYER_O_CODE, PLAYER_O_MARK, 5, &playerX);
-    //playGame.play(playerX, ai);
-
-    // Run a game between two minimax AI players.
-    //AIPlayerMinimax ai1 = AIPlayerMinimax(PLAYER_X_CODE, PLAYER_X_MARK, 9, NULL);
-    //AIPlayerMinimax ai2 = AIPlayerMinimax(PLAYER_O_CODE, PLAYER_O_MARK, 3, NULL);
-    //ai1.opponent = &ai2;
-    //ai2.opponent = &ai1;
-    //playGame.play(ai1, ai2);
-
-    // Run a game between two MCTS players.
-    //AIPlayerMonteCarlo ai1 = AIPlayerMonteCarlo(PLAYER_X_CODE, PLAYER_X_MARK, 100, NULL);
-    //AIPlayerMonteCarlo ai2 = AIPlayerMonteCarlo(PLAYER_O_CODE, PLAYER_O_MARK, 2, NULL);
-    //ai1.opponent = &ai2;
-    //ai2.opponent = &ai1;
-    //playGame.play(ai1, ai2);
+    //HumanPlayer<TicTacToe> playerX = HumanPlayer<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK);
+    //AIPlayerMinimax<TicTacToe> ai = AIPlayerMinimax<TicTacToe>(PLAYER_O_CODE, PLAYER_O_MARK, 5);
+    //Play().play(playerX, ai);
+
+    // Run a game between two MCTS players on a 5x5 board with 4 in a row.
+    //AIPlayerMonteCarlo<Board5x5x4> ai1 = AIPlayerMonteCarlo<Board5x5x4>(PLAYER_X_CODE, PLAYER_X_MARK, 100);
+    //AIPlayerMonteCarlo<Board5x5x4> ai2 = AIPlayerMonteCarlo<Board5x5x4>(PLAYER_O_CODE, PLAYER_O_MARK, 2);
+    //Play().play(ai1, ai2);
 
     // Command line inputs
     // Player O: -pO
     // Player X: -pX
     // Human player: -hp | --human
-    // Minimax player: --mm | --minimax
-    // Monte carlo player: --mc | --montecarlo
-    // Example: -pO mc 10 -pX mc 20
+    // Minimax player: --mm | --minimax <depth> [ms per move] [ab | pvs | mtdf] [batch]
+    // Monte carlo player: --mc | --montecarlo <iterations> [playouts per leaf] [root | tree | leaf]
+    // Proof-number search player: pn | proofnumber [node limit]
+    // Tablebase player (3x3 only): tb | tablebase [file]
+    // Tablebase for the AI players (3x3 only): -tablebase [file]
+    // Threads of the minimax and Monte Carlo players: -threads <n>
+    // Analysis of every move by the AI players: -analyze
+    // Seed of the random choices: -seed <n>
+    // Board size: -size <rows/cols> [-k <marks in a row>]
+    // Ultimate Tic Tac Toe: -ultimate
+    // Example: -pO mc 10 -pX mc 20 -size 4
 
     std::vector<std::string> inputs(argv, argv + argc);
 
     std::vector<std::string>::iterator helpLoc = std::find(inputs.begin(), inputs.end(), "-h");
-    std::vector<std::string>::iterator pOLoc = std::find(inputs.begin(), inputs.end(), "-pO");
-    std::vector<std::string>::iterator pXLoc = std::find(inputs.begin(), inputs.end(), "-pX");
-    std::vector<std::string>::iterator pOTypeLoc = ++pOLoc;
-    std::vector<std::string>::iterator pXTypeLoc = ++pXLoc;
+    std::vector<std::string>::iterator sizeLoc = std::find(inputs.begin(), inputs.end(), "-size");
+    std::vector<std::string>::iterator kLoc = std::find(inputs.begin(), inputs.end(), "-k");
+    std::vector<std::string>::iterator ultimateLoc = std::find(inputs.begin(), inputs.end(), "-ultimate");
+
+    // 3x3 by default.  k defaults to the size, up to 4 in a row.
+    int size = (sizeLoc != inputs.end() && sizeLoc + 1 != inputs.end()) ? std::stoi(*(sizeLoc + 1)) : 3;
+    int k = (kLoc != inputs.end() && kLoc + 1 != inputs.end()) ? std::stoi(*(kLoc + 1)) : std::min(size, 4);
 
     // Display help
     if(argc == 1 || helpLoc != inputs.end()) {
@@ -142,42 +286,48 @@ int main(int argc, char** argv) {
                     << "Player O: -pO\n" 
                     << "Player X: -pX\n"
                     << "Human player: hp | human\n"
-                    << "Minimax player: mm | minimax <tree depth>\n"
-                    << "Monte carlo player: mc | montecarlo <iterations>\n"
-                    << "Example: ./play -pO hp -pX mc 100" << std::endl;
+                    << "Minimax player: mm | minimax <tree depth> [ms per move, searching deeper until it runs out] [ab | pvs | mtdf] [batch]\n"
+                    << "    Search drivers: alpha-beta (default), principal variation search, MTD(f)\n"
+                    << "    batch: score the leaves of each position together, with SIMD on larger boards\n"
+                    << "Monte carlo player: mc | montecarlo <iterations> [playouts per leaf] [root | tree | leaf]\n"
+                    << "    Playouts per leaf: games played out from each leaf and backpropagated together (default 1)\n"
+                    << "    With -threads, each thread searches its own tree and the roots are merged (root, default),\n"
+                    << "    or every thread searches one shared tree, with virtual loss to spread them out (tree),\n"
+                    << "    or one thread searches and every thread plays out from each leaf (leaf)\n"
+                    << "Proof-number search player, which solves the game: pn | proofnumber [node limit] (default 4194304)\n"
+                    << "Tablebase player of perfect play (3x3 only): tb | tablebase [file] (default tictactoe.tb)\n"
+                    << "Look up AI moves of the 3x3 game in a tablebase: -tablebase [file] (default tictactoe.tb)\n"
+                    << "Threads of each minimax and Monte Carlo player: -threads <n> (default 1)\n"
+                    << "Print every move with its score and principal variation before each AI move: -analyze\n"
+                    << "Seed of the first player and the random choices of the AI players, to replay a game: -seed <n> (default: from the clock)\n"
+                    << "Board size: -size 3 | 4 | 5 | 7 (default 3)\n"
+                    << "Marks in a row to win: -k <k> (default: size, at most 4)\n"
+                    << "    Boards: 3x3 k=3, 4x4 k=3|4, 5x5 k=4|5, 7x7 k=4|5\n"
+                    << "Ultimate Tic Tac Toe on a 9x9 board: -ultimate\n"
+                    << "Example: ./play -pO hp -pX mc 100\n"
+                    << "Example: ./gen_tablebase && ./play -pO tb -pX mm 9 -tablebase\n"
+                    << "Example: ./play -pO mm 2 -pX mc 1000 -size 5 -k 4\n"
+                    << "Example: ./play -pO mm 2 -pX mc 1000 -ultimate\n"
+                    << "Example: ./play -pO mm 0 100 -pX mc 1000 -ultimate\n"
+                    << "Example: ./play -pO mm 4 mtdf -pX mm 4 pvs -size 4 -k 3\n"
+                    << "Example: ./play -pO mm 3 ab batch -pX mm 3 -size 7 -k 4\n"
+                    << "Example: ./play -pO mm 3 -pX pn -size 4 -k 3\n"
+                    << "Example: ./play -pO mm 3 -pX mc 1000 -size 4 -k 3 -analyze\n"
+                    << "Example: ./play -pO mm 4 -pX mc 1000 -ultimate -threads 8\n"
+                    << "Example: ./play -pO mm 4 -pX mc 1000 tree -ultimate -threads 8\n"
+                    << "Example: ./play -pO mm 3 -pX mc 1000 16 leaf -size 7 -k 4 -threads 8\n"
+                    << "Example: ./play -pO mc 1000 -pX mc 1000 -size 5 -k 4 -seed 42" << std::endl;
     }
+    else if(ultimateLoc != inputs.end()) runGame<UltimateBoard>(inputs);
+    else if(size == 3 && k == 3) runGame<TicTacToe>(inputs);
+    else if(size == 4 && k == 3) runGame<Board4x4x3>(inputs);
+    else if(size == 4 && k == 4) runGame<Board4x4x4>(inputs);
+    else if(size == 5 && k == 4) runGame<Board5x5x4>(inputs);
+    else if(size == 5 && k == 5) runGame<Board5x5x5>(inputs);
+    else if(size == 7 && k == 4) runGame<Board7x7x4>(inputs);
+    else if(size == 7 && k == 5) runGame<Board7x7x5>(inputs);
     else {
-        // Strict inputs
-        if(*pXTypeLoc == "hp" || *pXTypeLoc == "human") {
-            playerX = new HumanPlayer(PLAYER_X_CODE, PLAYER_X_MARK);
-        }
-        else if(*pXTypeLoc == "mm" || *pXTypeLoc == "minimax") {
-            playerX = new AIPlayerMinimax(PLAYER_X_CODE, PLAYER_X_MARK, std::stoi(*(++pXTypeLoc)));
-        }
-        else if(*pXTypeLoc == "mc" || *pXTypeLoc == "montecarlo") {
-            playerX = new AIPlayerMonteCarlo(PLAYER_X_CODE, PLAYER_X_MARK, std::stoi(*(++pXTypeLoc)));
-        }
-        else {
-            std::cout << "Error: Player X defined incorrectly." << std::endl;
-        }
-
-        if(*pOTypeLoc == "hp" || *pOTypeLoc == "human") {
-            playerO = new HumanPlayer(PLAYER_O_CODE, PLAYER_O_MARK);
-        }
-        else if(*pOTypeLoc == "mm" || *pOTypeLoc == "minimax") {
-            playerO = new AIPlayerMinimax(PLAYER_O_CODE, PLAYER_O_MARK, std::stoi(*(++pOTypeLoc)));
-        }
-        else if(*pOTypeLoc == "mc" || *pOTypeLoc == "montecarlo") {
-            playerO = new AIPlayerMonteCarlo(PLAYER_O_CODE, PLAYER_O_MARK, std::stoi(*(++pOTypeLoc)));
-        }
-        else {
-            std::cout << "Error: Player O defined incorrectly." << std::endl;
-        }
-
-        playGame.play(*playerX, *playerO);
-
-        delete playerX;
-        delete playerO;
+        std::cout << "Error: " << size << "x" << size << " boards with " << k << " in a row are not supported." << std::endl;
     }
 
     return 0;
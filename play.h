@@ -7,12 +7,16 @@
 #ifndef PLAY
 #define PLAY
 
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "player.h"
 #include "playerhuman.h"
 #include "playerminimax.h"
 #include "playermontecarlo.h"
+#include "playerproofnumber.h"
+#include "playertablebase.h"
 
 // Game players
 Player* playerX;
@@ -27,9 +31,30 @@ class Play {
     public:
         /**
          *  Play a game between any two kinds of players.
+         *  With @param analyze, print the analysis of every move by the player to move before it chooses one.
          *  Return PLAYER_X_WON, PLAYER_O_WON, or DRAW.
          */
-        int play(Player& playerX, Player& playerO);
+        template<class Board>
+        int play(BoardPlayer<Board>& playerX, BoardPlayer<Board>& playerO, bool analyze = false);
 };
 
+/**
+ *  Print the moves of @param analysis of the player with @param mark, one per line, with their scores and principal variations.
+ */
+void printAnalysis(char mark, const std::vector<MoveAnalysis>& analysis);
+
+/**
+ *  Create a player of the type given after @param typeLoc, or NULL if the type is unknown.
+ *  AI players look up moves of the 3x3 game in @param tablebase if it is not NULL.
+ *  Minimax and Monte Carlo players search with @param threads threads, and Monte Carlo players draw their random choices from @param seed.
+ */
+template<class Board>
+BoardPlayer<Board>* createPlayer(int code, char mark, std::vector<std::string>::iterator typeLoc, std::vector<std::string>::iterator end, const Tablebase* tablebase, int threads, uint64_t seed);
+
+/**
+ *  Create the players given by the command line inputs and run a game between them on the given board.
+ */
+template<class Board>
+void runGame(std::vector<std::string>& inputs);
+
 #endif  // PLAY
\ No newline at end of file
@@ -19,34 +19,6 @@ Player::~Player() {
     this->mark = 0;
 }
 
-bool gameStatesAreEqual(char g1[3][3], char g2[3][3]) {
-    bool result = true;
-
-    for(int i = 0; i < 9; i++) if(g1[int(i / 3)][i % 3] != g2[int(i / 3)][i % 3]) {
-        result = false;
-        break;
-    }
-
-    return result;
-}
-
-std::list<moveRCPair> getValidActions(char gameState[3][3]) {
-    std::list<moveRCPair> actions;
-
-    for(int i = 0; i < 9; i++) {
-        int row = int(i / 3);
-        int col = i % 3;
-        if(gameState[row][col] == CLEAR) {
-            moveRCPair move;
-            move.row = row;
-            move.column = col;
-            actions.push_back(move);
-        }
-    }
-
-    return actions;
-}
-
 moveRCPair Player::processPlayerInput(std::string input) {
     moveRCPair pair;
     std::string inputCopy = input;
@@ -11,23 +11,41 @@
 #include "defines.h"
 
 #include <iostream>
-#include <list>
+#include <vector>
 
 #include "game.h"
+#include "ultimate.h"
 
-class Game; // forware declaration
-
-#define copyGameState(original, copyTo) for(int i = 0; i < 9; i++) copyTo[int(i / 3)][i % 3] = original[int(i / 3)][i % 3];
+template<class Board> class Game; // forware declaration
 
 /**
  * Returns whether or not two grids are equal.
  */
-bool gameStatesAreEqual(char g1[3][3], char g2[3][3]);
+template<class Board>
+inline bool gameStatesAreEqual(const Board& g1, const Board& g2) {
+    return g1 == g2;
+}
 
 /**
- *  Get a list of valid actions.
+ *  Get the set of valid actions.
  */
-std::list<moveRCPair> getValidActions(char gameState[3][3]);
+template<int R, int C, int K>
+inline typename BitBoard<R, C, K>::MoveSet getValidActions(const BitBoard<R, C, K>& gameState) {
+    typename BitBoard<R, C, K>::MoveSet actions;
+    actions.cells = ~gameState.occupied() & BitBoard<R, C, K>::FULL;
+
+    return actions;
+}
+
+/**
+ *  A move of an analyzed position, with its score for the player to move and the line of play the engine expects after it.
+ *  Scores are in the engine's units: the minimax heuristic, or the Monte Carlo value of the move.
+ */
+struct MoveAnalysis {
+    moveRCPair move;
+    double score = 0;
+    std::vector<moveRCPair> pv;   // Principal variation, starting with move
+};
 
 class Player {
     public:
@@ -45,12 +63,21 @@ class Player {
          *  Player input must be validated before this using Game::validatePlayerInput().
          */
         moveRCPair processPlayerInput(std::string input);
+};
+
+/**
+ *  A player of games on the given board type.
+ */
+template<class Board>
+class BoardPlayer: public Player {
+    public:
+        BoardPlayer(int code, char mark): Player(code, mark) {}
 
         /**
          *  Return a moveRCPair after looking at the game.
          *  Wait for the human player to enter his/her move.  The AI player will calculate the best move and the return it.
          */
-        virtual moveRCPair chooseMove(Game* game) {
+        virtual moveRCPair chooseMove(Game<Board>* game) {
             // dummy body
 #if defined(DEBUG)
             std::cout << "Dummy function called" << std::endl;
@@ -58,6 +85,14 @@ class Player {
             moveRCPair dummy;
             return dummy;
         };
+
+        /**
+         *  Return every valid move of the game with its score and principal variation, best first, from one search.
+         *  Players that do not search return an empty list.
+         */
+        virtual std::vector<MoveAnalysis> analyze(Game<Board>* game) {
+            return std::vector<MoveAnalysis>();
+        }
 };
 
-#endif  // PLAYER
\ No newline at end of file
+#endif  // PLAYER
@@ -9,7 +9,8 @@
 #if defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
 #include <iostream>
 #endif  // defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
-moveRCPair HumanPlayer::chooseMove(Game* game) {
+template<class Board>
+moveRCPair HumanPlayer<Board>::chooseMove(Game<Board>* game) {
     std::string input;
     do {
 #if defined(VERBOSE) || defined(DEBUG)
@@ -20,9 +21,12 @@ moveRCPair HumanPlayer::chooseMove(Game* game) {
         std::cin >> input;
     } while(game->validatePlayerInput(input));
 
-    moveRCPair move = processPlayerInput(input);
+    moveRCPair move = this->processPlayerInput(input);
 #if defined(VERBOSE) || defined(DEBUG)
     std::cout << "\tPlayer " << this->mark << " marks " << move.row << "," << move.column << std::endl; 
 #endif
     return move;
-}
\ No newline at end of file
+}
+
+#define INSTANTIATE_HUMANPLAYER(Board) template class HumanPlayer<Board>;
+FOR_EACH_GAME(INSTANTIATE_HUMANPLAYER)
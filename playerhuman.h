@@ -10,9 +10,10 @@
 
 #include "player.h"
 
-class HumanPlayer: public Player {
+template<class Board>
+class HumanPlayer: public BoardPlayer<Board> {
     public:
-        HumanPlayer(int code, char mark):Player(code, mark) {
+        HumanPlayer(int code, char mark):BoardPlayer<Board>(code, mark) {
             // Introduction
 #if defined(VERBOSE)
             std::cout << "Introducing Player " << this->mark << ", who is a human player" << std::endl;
@@ -21,7 +22,7 @@ class HumanPlayer: public Player {
 
         ~HumanPlayer() {}
 
-        moveRCPair chooseMove(Game* game);
+        moveRCPair chooseMove(Game<Board>* game);
 };
 
-#endif  // HUMANPLAYER
\ No newline at end of file
+#endif  // HUMANPLAYER
@@ -5,217 +5,616 @@
 
 #include "playerminimax.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #if defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
 #include <iostream>
 #endif  // defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
 
-moveRCPair AIPlayerMinimax::chooseMove(Game* game) {
+template<class Board>
+moveRCPair AIPlayerMinimax<Board>::chooseMove(Game<Board>* game) {
+    if constexpr(std::is_same<Board, TicTacToe>::value) {
+        const TablebaseEntry* entry = (this->tablebase != NULL) ? this->tablebase->lookup(game->board.state, this->code) : NULL;
+        if(entry != NULL && entry->bestMoves != 0) {
+            moveRCPair move = Tablebase::pickMove(entry);
+#if defined(VERBOSE) || defined(DEBUG)
+            std::cout << "\tFound optimal move in the tablebase: " << move.row << ", " << move.column << " of value " << (int)entry->value << std::endl;
+#elif defined(MINIMAL_VERBOSE)
+            std::cout << game->turns << " " << this->mark << ":" << move.row << "," << move.column << std::endl;
+#endif
+            return move;
+        }
+    }
+
+    if(this->useThreats) {
+        ForcedMove forced = forcedMove(game->board.state, this->mark, this->opponentMark);
+        if(forced.kind != THREAT_NONE) {
+            this->treeSize = 0;
+#if defined(VERBOSE) || defined(DEBUG)
+            std::cout << "\tFound forced move (" << THREAT_NAMES[forced.kind] << "): " << forced.move.row << ", " << forced.move.column << std::endl;
+#elif defined(MINIMAL_VERBOSE)
+            std::cout << game->turns << " " << this->mark << ":" << forced.move.row << "," << forced.move.column << std::endl;
+#endif
+            return forced.move;
+        }
+    }
+
     this->treeSize = 0;
-    // Create game tree
+    this->tableHits = 0;
+    this->mtdfResearches = 0;
+    this->ordering.newSearch();
+    for(AIPlayerMinimax* helper : this->helpers) helper->ordering.newSearch();
+    this->searchedDepth = std::min(this->depthLimit * 2, Board::CELLS - countBits(game->board.state.occupied()));
     moveRCPair initialAction;
-    MinimaxTreeNode* gameTree = createGameTree(initialAction, game->board.grid, this->depthLimit * 2);
+    Game<Board> search(game->board.state, this->code);
+    search.hashSymmetries(this->useSymmetry);
+    Node* gameTree = NULL;
+    std::pair<moveRCPair, int> minimax;
+    if(this->inPlace) {
+        // Search without a tree
+        if(!this->persistTable) this->table.clear();
+        this->rootMove = std::make_pair(-1, -1);
+        if(this->timeBudget > 0) minimax = iterativeDeepeningSearch(search, this->depthLimit * 2);
+        else minimax = rootSearch(search, this->depthLimit * 2, this->lastValue, initialAction);
+#if defined(VERBOSE) || defined(DEBUG)
+        std::cout << "\tMinimax AI searched game tree of size " << treeSize;
+        if(this->threads > 1) std::cout << " on " << this->threads << " threads";
+        if(this->useTable) std::cout << " with " << this->tableHits << " transposition table hits";
+        std::cout << std::endl;
+#endif  // defined(VERBOSE) || defined(DEBUG)
+    }
+    else {
+        // Create game tree
+        gameTree = createGameTree(initialAction, search, this->depthLimit * 2);
 #if defined(VERBOSE) || defined(DEBUG)
-    std::cout << "\tMinimax AI created game tree of size " << treeSize << std::endl;
+        std::cout << "\tMinimax AI created game tree of size " << treeSize << " (peak " << this->nodePool.peak() << ") in "
+                    << this->nodePool.memoryUsed() / 1024 << " KiB" << std::endl;
 #endif  // defined(VERBOSE) || defined(DEBUG)
-    // Perform minimax search and get the best move
-    std::pair<moveRCPair, int> minimax = minimaxSearch(gameTree, this->depthLimit * 2, -1000, 1000, true, initialAction);
+        // Perform minimax search and get the best move
+        minimax = minimaxSearch(gameTree, this->depthLimit * 2, -1000, 1000, true, initialAction);
+    }
     moveRCPair optAction = minimax.first;
+    this->lastValue = minimax.second;
 #if defined(VERBOSE) || defined(DEBUG)
+    if(this->ordering.interiorNodes > 0) {
+        std::cout << "\t" << (double)this->ordering.cutoffs / this->ordering.interiorNodes << " cutoffs per node ("
+                    << 100 * this->ordering.firstMoveCutoffs / std::max(this->ordering.cutoffs, 1L) << "% by the first move), effective branching factor "
+                    << MoveOrderer<Board>::effectiveBranchingFactor(this->treeSize, this->searchedDepth) << std::endl;
+    }
     std::cout << "\tFound optimal move: " << optAction.row << ", " << optAction.column << " of value " << minimax.second << std::endl;
 #elif defined(MINIMAL_VERBOSE)
     std::cout << game->turns << " " << this->mark << ":" << optAction.row << "," << optAction.column << std::endl;
 #endif
     // Delete the game tree
-    deleteTree(gameTree);
+    if(gameTree != NULL) deleteTree();
 
     return optAction;
 }
 
-std::pair<moveRCPair, int> AIPlayerMinimax::minimaxSearch(MinimaxTreeNode* node, int depth, int alpha, int beta, bool maxPlayer, moveRCPair action) {
-    if(depth == 0 || node->successors.size() == 0) {
+template<class Board>
+std::vector<MoveAnalysis> AIPlayerMinimax<Board>::analyze(Game<Board>* game) {
+    std::vector<MoveAnalysis> analysis;
+    Game<Board> search(game->board.state, this->code);
+    search.hashSymmetries(this->useSymmetry);
+    if(search.result != ONGOING) return analysis;
+
+    this->treeSize = 0;
+    this->tableHits = 0;
+    this->mtdfResearches = 0;
+    this->timedOut = false;
+    this->rootMove = std::make_pair(-1, -1);
+    this->ordering.newSearch();
+    if(!this->persistTable) this->table.clear();
+    int depth = this->depthLimit * 2;
+    moveRCPair initialAction;
+
+    for(moveRCPair move : getValidActions(search.board.state)) {
+        MoveAnalysis entry;
+        entry.move = move;
+        entry.pv.push_back(move);
+        search.makeMove(move.row, move.column);
+        entry.score = -1 * negamaxSearch(search, depth - 1, -1000, 1000, -1, initialAction).second;
+        principalVariation(search, depth - 1, entry.pv);
+        search.undoMove();
+        analysis.push_back(entry);
+    }
+
+    // Best first.  Ties keep the order of the moves, as the search would settle them.
+    std::stable_sort(analysis.begin(), analysis.end(), [](const MoveAnalysis& a, const MoveAnalysis& b) { return a.score > b.score; });
+#if defined(VERBOSE) || defined(DEBUG)
+    std::cout << "\tMinimax AI analyzed " << analysis.size() << " moves in a game tree of size " << this->treeSize << std::endl;
+#endif  // defined(VERBOSE) || defined(DEBUG)
+    return analysis;
+}
+
+template<class Board>
+void AIPlayerMinimax<Board>::principalVariation(Game<Board>& game, int depth, std::vector<moveRCPair>& pv) {
+    int made = 0;
+    TableEntry entry;
+    while(made < depth && game.result == ONGOING && this->useTable) {
+        int symmetry = (this->useSymmetry) ? game.canonicalSymmetry() : 0;
+        if(!this->table.probe(game.hash(symmetry), entry) || entry.moveRow < 0) break;
+        moveRCPair move = untransformMove<Board>(std::make_pair((int)entry.moveRow, (int)entry.moveCol), symmetry);
+        // Another position may have taken the slot
+        if(!getValidActions(game.board.state).contains(move.row, move.column)) break;
+        pv.push_back(move);
+        game.makeMove(move.row, move.column);
+        made++;
+    }
+    for(; made > 0; made--) game.undoMove();
+}
+
+template<class Board>
+std::pair<moveRCPair, int> AIPlayerMinimax<Board>::minimaxSearch(Node* node, int depth, int alpha, int beta, bool maxPlayer, moveRCPair action) {
+    if(depth == 0 || node->numOfSuccessors == 0) {
         return std::make_pair(action, evalFunction(node));
     }
 
+    // Successors in the order to search them.  The root keeps its order.
+    Node* successors[Board::CELLS];
+    int numOfSuccessors = node->numOfSuccessors;
+    for(int i = 0; i < numOfSuccessors; i++) successors[i] = node->successors + i;
+    int ply = this->depthLimit * 2 - depth;
+    char mark = (maxPlayer) ? this->mark : this->opponentMark;
+    char opponent = (maxPlayer) ? this->opponentMark : this->mark;
+    if(ply > 0 && this->ordering.moveOrdering != 0) {
+        moveRCPair moves[Board::CELLS];
+        int scores[Board::CELLS];
+        for(int i = 0; i < numOfSuccessors; i++) moves[i] = successors[i]->action;
+        this->ordering.scoreMoves(node->gameState, moves, numOfSuccessors, mark, opponent, ply, scores);
+        MoveOrderer<Board>::sortByScore(successors, scores, numOfSuccessors);
+    }
+
+    moveRCPair localAction = action; // track optimal action
+    int cutoffIndex = -1;
+    int value;
     if(maxPlayer) { // player is self
-        moveRCPair localAction = action; // track optimal action
         int maxValue = -1000;  // negative infinity
-        for(MinimaxTreeNode* successor : node->successors) {
-            std::pair<moveRCPair, int> temp = minimaxSearch(successor, depth - 1, alpha, beta, false, action);
+        for(int i = 0; i < numOfSuccessors; i++) {
+            std::pair<moveRCPair, int> temp = minimaxSearch(successors[i], depth - 1, alpha, beta, false, action);
             if(temp.second > maxValue) {
                 maxValue = temp.second;
-                localAction = successor->action;
+                localAction = successors[i]->action;
             }
 
             // Alpha-beta pruning
-            if(maxValue >= beta) break;
+            if(maxValue >= beta) {
+                cutoffIndex = i;
+                break;
+            }
             alpha = (alpha > maxValue) ? alpha : maxValue;
         }
-        return std::make_pair(localAction, maxValue);
+        value = maxValue;
     }
     else {  // player is opponent
-        moveRCPair localAction = action; // track optimal action
         int minValue = 1000;  // infinity
-        for(MinimaxTreeNode* successor : node->successors) {
-            std::pair<moveRCPair, int> temp = minimaxSearch(successor, depth - 1, alpha, beta, true, action);
+        for(int i = 0; i < numOfSuccessors; i++) {
+            std::pair<moveRCPair, int> temp = minimaxSearch(successors[i], depth - 1, alpha, beta, true, action);
             if(temp.second < minValue) {
                 minValue = temp.second;
-                localAction = successor->action;
+                localAction = successors[i]->action;
             }
 
             // Alpha-beta pruning
-            if(minValue <= alpha) break;
+            if(minValue <= alpha) {
+                cutoffIndex = i;
+                break;
+            }
             beta = (minValue < beta) ? minValue : beta;
         }
-        return std::make_pair(localAction, minValue);
+        value = minValue;
     }
+
+    this->ordering.record(Board::toCell(localAction.row, localAction.column), mark, ply, depth, cutoffIndex >= 0, cutoffIndex);
+    return std::make_pair(localAction, value);
 }
 
-int AIPlayerMinimax::evalFunction(MinimaxTreeNode* node) {
-    /**
-     * Heuristic = 3X3(s) + 3X2(s) + X1(s) - (3O3(s) + 3O2(s) + O1(s)) 
-     * Xn is the number of rows, columns, or diagonals with just n X's.
-     * On is the number of rows, columns, or diagonals with just n O's.
-     * In this case, X is this player's mark.
-     */
+template<class Board>
+std::pair<moveRCPair, int> AIPlayerMinimax<Board>::iterativeDeepeningSearch(Game<Board>& game, int maxDepth) {
+    this->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(this->timeBudget);
+    this->timedOut = false;
 
-    int own3 = 0;
-    int own2 = 0;
-    int own1 = 0;
-    int opp3 = 0;
-    int opp2 = 0;
-    int opp1 = 0;
-
-    // Iterate rows
-    for(int r = 0; r < 3; r++) {
-        int ownCount = 0;
-        int oppCount = 0;
-        for(int c = 0; c < 3; c++) {
-            if(node->gameState[r][c] == this->mark) ownCount++;
-            else if(node->gameState[r][c] == this->opponentMark) oppCount++;
-        }
-        if(ownCount == 0) {
-            if(oppCount == 1) opp1++;
-            else if(oppCount == 2) opp2++;
-            else if(oppCount == 3) opp3++;
-        }
-        if(oppCount == 0) {
-            if(ownCount == 1) own1++;
-            else if(ownCount == 2) own2++;
-            else if(ownCount == 3) own3++;
-        }
+    // Deeper searches than the boxes left give the same result
+    int lastDepth = std::min(maxDepth, Board::CELLS - countBits(game.board.state.occupied()));
+    std::pair<moveRCPair, int> best;
+    int depth = 1;
+    for(; depth <= lastDepth; depth++) {
+        std::pair<moveRCPair, int> result = rootSearch(game, depth, (depth == 1) ? this->lastValue : best.second, best.first);
+        if(this->timedOut) break;
+
+        best = result;
+        this->rootMove = result.first;
+        this->searchedDepth = depth;
     }
+#if defined(VERBOSE) || defined(DEBUG)
+    std::cout << "\tMinimax AI completed " << depth - 1 << " of " << lastDepth << " layers in " << this->timeBudget << " ms" << std::endl;
+#endif  // defined(VERBOSE) || defined(DEBUG)
 
-    // Iterate columns
-    for(int c = 0; c < 3; c++) {
-        int ownCount = 0;
-        int oppCount = 0;
-        for(int r = 0; r < 3; r++) {
-            if(node->gameState[r][c] == this->mark) ownCount++;
-            else if(node->gameState[r][c] == this->opponentMark) oppCount++;
-        }
-        if(ownCount == 0) {
-            if(oppCount == 1) opp1++;
-            else if(oppCount == 2) opp2++;
-            else if(oppCount == 3) opp3++;
+    return best;
+}
+
+template<class Board>
+std::pair<moveRCPair, int> AIPlayerMinimax<Board>::rootSearch(Game<Board>& game, int depth, int guess, moveRCPair action) {
+    if(this->searchMode == SEARCH_MTDF) return mtdfSearch(game, depth, guess, action);
+    if(this->threads > 1) return parallelSearch(game, depth, action);
+    return negamaxSearch(game, depth, -1000, 1000, 1, action);
+}
+
+template<class Board>
+std::pair<moveRCPair, int> AIPlayerMinimax<Board>::mtdfSearch(Game<Board>& game, int depth, int guess, moveRCPair action) {
+    int lower = -1000;
+    int upper = 1000;
+    // The beta of the last search that failed high, whose best move is the first at least that good
+    int highBeta = -1000;
+    std::pair<moveRCPair, int> best = std::make_pair(action, guess);
+    int value = std::max(-999, std::min(guess, 999));
+    while(lower < upper) {
+        int beta = (value == lower) ? value + 1 : value;
+        std::pair<moveRCPair, int> result = negamaxSearch(game, depth, beta - 1, beta, 1, action);
+        if(this->timedOut) return result;
+
+        value = result.second;
+        if(value < beta) upper = value;
+        else {
+            lower = value;
+            highBeta = beta;
+            best = result;
         }
-        if(oppCount == 0) {
-            if(ownCount == 1) own1++;
-            else if(ownCount == 2) own2++;
-            else if(ownCount == 3) own3++;
+    }
+
+    if(highBeta != value) {
+        // A fail high below the value may be on an earlier move than the first of the value
+        this->mtdfResearches++;
+        best = negamaxSearch(game, depth, value - 1, value, 1, action);
+        if(this->timedOut) return best;
+    }
+    return std::make_pair(best.first, value);
+}
+
+template<class Board>
+std::pair<moveRCPair, int> AIPlayerMinimax<Board>::parallelSearch(Game<Board>& game, int depth, moveRCPair action) {
+    // Moves in the order of the serial root
+    typename Board::MoveSet validActions = getValidActions(game.board.state);
+    moveRCPair moves[Board::CELLS];
+    int numOfMoves = 0;
+    if(this->rootMove.row >= 0 && validActions.contains(this->rootMove.row, this->rootMove.column)) {
+        moves[numOfMoves++] = this->rootMove;
+        validActions.cells &= ~(typename Board::Mask(1) << Board::toCell(this->rootMove.row, this->rootMove.column));
+    }
+    for(moveRCPair move : validActions) moves[numOfMoves++] = move;
+
+    // Too little to split
+    if(depth < 2 || numOfMoves < 2) return negamaxSearch(game, depth, -1000, 1000, 1, action);
+
+    this->treeSize++;
+    // The first move is searched alone for a bound to search the others with
+    game.makeMove(moves[0].row, moves[0].column);
+    int firstValue = -1 * negamaxSearch(game, depth - 1, -1000, 1000, -1, action).second;
+    game.undoMove();
+    if(this->timedOut) return std::make_pair(moves[0], firstValue);
+
+    while((int)this->helpers.size() < this->threads - 1) this->helpers.push_back(new AIPlayerMinimax(this));
+
+    std::mutex bestLock;
+    moveRCPair bestMove = moves[0];
+    int bestValue = firstValue;
+    int bestIndex = 0;
+    std::atomic<int> next(1);
+
+    // Take moves until none are left.  A move after the best only matters if it is better, and one before it if it ties.
+    auto searchMoves = [&](AIPlayerMinimax* searcher) {
+        Game<Board> position(game.board.state, game.currentPlayer);
+        position.hashSymmetries(this->useSymmetry);
+        for(int i = next++; i < numOfMoves; i = next++) {
+            int alpha;
+            {
+                std::lock_guard<std::mutex> guard(bestLock);
+                alpha = (i > bestIndex) ? bestValue : bestValue - 1;
+            }
+            position.makeMove(moves[i].row, moves[i].column);
+            int value = -1 * searcher->negamaxSearch(position, depth - 1, -1000, -1 * alpha, -1, action).second;
+            position.undoMove();
+            if(searcher->timedOut) return;
+            if(value <= alpha) continue;
+
+            std::lock_guard<std::mutex> guard(bestLock);
+            if(value > bestValue || (value == bestValue && i < bestIndex)) {
+                bestMove = moves[i];
+                bestValue = value;
+                bestIndex = i;
+            }
         }
+    };
+
+    std::vector<std::thread> workers;
+    for(int t = 0; t < this->threads - 1; t++) {
+        AIPlayerMinimax* helper = this->helpers[t];
+        helper->useTable = this->useTable;
+        helper->useSymmetry = this->useSymmetry;
+        helper->searchMode = this->searchMode;
+        helper->batchLeaves = this->batchLeaves;
+        helper->ordering.moveOrdering = this->ordering.moveOrdering;
+        helper->timeBudget = this->timeBudget;
+        helper->deadline = this->deadline;
+        helper->rootMove = this->rootMove;
+        helper->timedOut = false;
+        helper->treeSize = 0;
+        helper->tableHits = 0;
+        helper->ordering.interiorNodes = 0;
+        helper->ordering.cutoffs = 0;
+        helper->ordering.firstMoveCutoffs = 0;
+        workers.emplace_back(searchMoves, helper);
     }
+    searchMoves(this);
+    for(std::thread& worker : workers) worker.join();
 
-    // Check backwards diagnol
-    int ownCount = 0;
-    int oppCount = 0;
-    for(int d = 0; d < 3; d++) {
-        if(node->gameState[d][d] == this->mark) ownCount++;
-        else if(node->gameState[d][d] == this->opponentMark) oppCount++;
+    for(int t = 0; t < this->threads - 1; t++) {
+        AIPlayerMinimax* helper = this->helpers[t];
+        this->treeSize += helper->treeSize;
+        this->tableHits += helper->tableHits;
+        this->ordering.interiorNodes += helper->ordering.interiorNodes;
+        this->ordering.cutoffs += helper->ordering.cutoffs;
+        this->ordering.firstMoveCutoffs += helper->ordering.firstMoveCutoffs;
+        this->timedOut = this->timedOut || helper->timedOut;
     }
-    if(ownCount == 0) {
-        if(oppCount == 1) opp1++;
-        else if(oppCount == 2) opp2++;
-        else if(oppCount == 3) opp3++;
+    if(this->timedOut) return std::make_pair(bestMove, bestValue);
+
+    this->ordering.record(Board::toCell(bestMove.row, bestMove.column), codeToMark(game.currentPlayer), game.turns, depth, false, -1);
+    if(this->useTable) {
+        int symmetry = (this->useSymmetry) ? game.canonicalSymmetry() : 0;
+        int tableDepth = std::min(depth, Board::CELLS - countBits(game.board.state.occupied()));
+        this->table.store(game.hash(symmetry), bestValue, tableDepth, EXACT_BOUND, transformMove<Board>(bestMove, symmetry));
     }
-    if(oppCount == 0) {
-        if(ownCount == 1) own1++;
-        else if(ownCount == 2) own2++;
-        else if(ownCount == 3) own3++;
+
+    return std::make_pair(bestMove, bestValue);
+}
+
+template<class Board>
+std::pair<moveRCPair, int> AIPlayerMinimax<Board>::negamaxSearch(Game<Board>& game, int depth, int alpha, int beta, int color, moveRCPair action) {
+    this->treeSize++;
+    // Look at the clock every 1024 states.  The first iteration has no move to fall back on, so it always finishes.
+    if(this->timeBudget > 0 && this->rootMove.row >= 0 && (this->treeSize & 1023) == 0
+            && std::chrono::steady_clock::now() >= this->deadline) {
+        this->timedOut = true;
     }
+    if(this->timedOut) return std::make_pair(action, 0);
 
-    // Check forward diagnol
-    ownCount = 0;
-    oppCount = 0;
-    for(int d = 0; d < 3; d++) {
-        if(node->gameState[d][COLS - 1 - d] == this->mark) ownCount++;
-        else if(node->gameState[d][COLS - 1 - d] == this->opponentMark) oppCount++;
+    typename Board::MoveSet validActions = getValidActions(game.board.state);
+
+    if(depth == 0 || validActions.empty()) {
+        return std::make_pair(action, color * evalFunction(game));
     }
-    if(ownCount == 0) {
-        if(oppCount == 1) opp1++;
-        else if(oppCount == 2) opp2++;
-        else if(oppCount == 3) opp3++;
+
+    // Searches deeper than the boxes left give the same value, so they share entries.
+    int tableDepth = std::min(depth, Board::CELLS - countBits(game.board.state.occupied()));
+    int originalAlpha = alpha;
+    int originalBeta = beta;
+    // The root is never cut off or reordered by the table, so ties still go to the first move.
+    bool isRoot = (game.turns == 0);
+
+    // Moves in the order to search them
+    moveRCPair moves[Board::CELLS];
+    int numOfMoves = 0;
+    // Symmetric positions share an entry, keyed and with the best move stored on the canonical board
+    int symmetry = (this->useSymmetry) ? game.canonicalSymmetry() : 0;
+    // Helpers search with their owner's table
+    TranspositionTable& table = (this->owner != NULL) ? this->owner->table : this->table;
+    TableEntry entry;
+    if(this->useTable && table.probe(game.hash(symmetry), entry)) {
+        this->tableHits++;
+        if(!isRoot) {
+            moveRCPair tableMove = std::make_pair((int)entry.moveRow, (int)entry.moveCol);
+            if(entry.moveRow >= 0) tableMove = untransformMove<Board>(tableMove, symmetry);
+            if(entry.depth == tableDepth) {
+                if(entry.bound == EXACT_BOUND
+                        || (entry.bound == LOWER_BOUND && entry.value >= beta)
+                        || (entry.bound == UPPER_BOUND && entry.value <= alpha)) {
+                    return std::make_pair(tableMove, (int)entry.value);
+                }
+            }
+            // Try the best move of the last search first
+            if(entry.moveRow >= 0 && validActions.contains(tableMove.row, tableMove.column)) {
+                moves[numOfMoves++] = tableMove;
+                validActions.cells &= ~(typename Board::Mask(1) << Board::toCell(tableMove.row, tableMove.column));
+            }
+        }
     }
-    if(oppCount == 0) {
-        if(ownCount == 1) own1++;
-        else if(ownCount == 2) own2++;
-        else if(ownCount == 3) own3++;
+    if(isRoot && this->rootMove.row >= 0 && validActions.contains(this->rootMove.row, this->rootMove.column)) {
+        // Try the best move of the last iteration first
+        moves[numOfMoves++] = this->rootMove;
+        validActions.cells &= ~(typename Board::Mask(1) << Board::toCell(this->rootMove.row, this->rootMove.column));
     }
+    int firstOrdered = numOfMoves;
+    for(moveRCPair move : validActions) moves[numOfMoves++] = move;
 
-    int h = 3 * own3 + 3 * own2 + own1 - (3 * opp3 + 3 * opp2 + opp1);
+    char mark = codeToMark(game.currentPlayer);
+    if(!isRoot && this->ordering.moveOrdering != 0) {
+        // Order the moves after the table's
+        int scores[Board::CELLS];
+        char opponent = (mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK;
+        this->ordering.scoreMoves(game.board.state, moves + firstOrdered, numOfMoves - firstOrdered, mark, opponent, game.turns, scores);
+        MoveOrderer<Board>::sortByScore(moves + firstOrdered, scores, numOfMoves - firstOrdered);
+    }
+
+    // The opponent's best value is the worst for this player, so each player maximizes the negated value of the replies.
+    moveRCPair localAction = action; // track optimal action
+    int value = -1000;  // negative infinity
+    int cutoffIndex = -1;
+    // Scores of the leaves, made a batch at a time when batchLeaves is set
+    Board leaves[BATCH_WIDTH];
+    int leafScores[BATCH_WIDTH];
+    for(int i = 0; i < numOfMoves; i++) {
+        int temp;
+        if(depth == 1 && this->batchLeaves) {
+            if(i % BATCH_WIDTH == 0) {
+                // The replies are all leaves, so score the next few boards at once instead of making each move.
+                // Only the boards of one batch are scored past a cutoff.
+                int batch = std::min(BATCH_WIDTH, numOfMoves - i);
+                for(int j = 0; j < batch; j++) {
+                    leaves[j] = game.board.state;
+                    leaves[j].set(moves[i + j].row, moves[i + j].column, mark);
+                }
+                this->evalFunction(leaves, batch, leafScores);
+                // The clock is looked at as if the leaves were visited one by one
+                int visited = this->treeSize;
+                this->treeSize += batch;
+                if(this->timeBudget > 0 && this->rootMove.row >= 0 && (visited >> 10) != (this->treeSize >> 10)
+                        && std::chrono::steady_clock::now() >= this->deadline) {
+                    this->timedOut = true;
+                    return std::make_pair(localAction, value);
+                }
+            }
+            // A leaf's value is the same for any window
+            temp = color * leafScores[i % BATCH_WIDTH];
+        }
+        else {
+            game.makeMove(moves[i].row, moves[i].column);
+            if(i == 0 || this->searchMode != SEARCH_PVS) {
+                temp = -1 * negamaxSearch(game, depth - 1, -1 * beta, -1 * alpha, -1 * color, action).second;
+            }
+            else {
+                // Only a move better than the best so far needs its value
+                temp = -1 * negamaxSearch(game, depth - 1, -1 * alpha - 1, -1 * alpha, -1 * color, action).second;
+                if(temp > alpha && temp < beta && !this->timedOut) {
+                    temp = -1 * negamaxSearch(game, depth - 1, -1 * beta, -1 * alpha, -1 * color, action).second;
+                }
+            }
+            game.undoMove();
+            // The value is incomplete, so keep it out of the table
+            if(this->timedOut) return std::make_pair(localAction, value);
+        }
+        if(temp > value) {
+            value = temp;
+            localAction = moves[i];
+        }
+
+        // Alpha-beta pruning
+        if(value >= beta) {
+            cutoffIndex = i;
+            break;
+        }
+        alpha = (alpha > value) ? alpha : value;
+    }
+    this->ordering.record(Board::toCell(localAction.row, localAction.column), mark, game.turns, depth, cutoffIndex >= 0, cutoffIndex);
 
-    return h;
+    if(this->useTable) {
+        uint8_t bound = (value <= originalAlpha) ? UPPER_BOUND : ((value >= originalBeta) ? LOWER_BOUND : EXACT_BOUND);
+        table.store(game.hash(symmetry), value, tableDepth, bound, transformMove<Board>(localAction, symmetry));
+    }
+
+    return std::make_pair(localAction, value);
+}
+
+template<class Board>
+AIPlayerMinimax<Board>::AIPlayerMinimax(AIPlayerMinimax* owner): BoardPlayer<Board>(owner->code, owner->mark), table(0) {
+    this->owner = owner;
+    this->depthLimit = owner->depthLimit;
+    this->opponentMark = owner->opponentMark;
+}
+
+template<class Board>
+int AIPlayerMinimax<Board>::evalFunction(Node* node) {
+    return evalFunction(node->gameState);
+}
+
+template<class Board>
+int AIPlayerMinimax<Board>::evalFunction(const Board& gameState) {
+    /**
+     * Heuristic = 3X3(s) + 3X2(s) + X1(s) - (3O3(s) + 3O2(s) + O1(s)) 
+     * Xn is the number of rows, columns, or diagonals with just n X's.
+     * On is the number of rows, columns, or diagonals with just n O's.
+     * In this case, X is this player's mark.
+     * On boards with more than 3 in a row, every line with 2 or more of just one mark counts 3.
+     * See evaluation.h.  The mark is only looked at here, and the rest is specialized for it.
+     */
+    return (this->mark == PLAYER_X_MARK) ? evaluate<PLAYER_X_MARK>(gameState) : evaluate<PLAYER_O_MARK>(gameState);
+}
+
+template<class Board>
+int AIPlayerMinimax<Board>::evalFunction(const Game<Board>& game) {
+    // Boards larger than 3x3 score the line counts that the game already keeps
+    if constexpr(!std::is_same<Board, UltimateBoard>::value && !std::is_same<Board, TicTacToe>::value) {
+        return (this->mark == PLAYER_X_MARK) ? evaluate<PLAYER_X_MARK>(game.tracker) : evaluate<PLAYER_O_MARK>(game.tracker);
+    }
+    else return evalFunction(game.board.state);
+}
+
+template<class Board>
+void AIPlayerMinimax<Board>::evalFunction(const Board* gameStates, int n, int* scores) {
+    if(this->mark == PLAYER_X_MARK) evaluateBatch<PLAYER_X_MARK>(gameStates, n, scores);
+    else evaluateBatch<PLAYER_O_MARK>(gameStates, n, scores);
 }
 
-MinimaxTreeNode* AIPlayerMinimax::createGameTree(moveRCPair action, char gameState[3][3], int layer) {
+template<class Board>
+typename AIPlayerMinimax<Board>::Node* AIPlayerMinimax<Board>::createGameTree(moveRCPair action, Game<Board>& game, int layer) {
+    Node* root = &this->nodePool[this->nodePool.allocate()];
+    growTree(root, action, game, layer);
+    return root;
+}
+
+template<class Board>
+void AIPlayerMinimax<Board>::growTree(Node* node, moveRCPair action, Game<Board>& game, int layer) {
     this->treeSize++;
-    // Create a new node
-    MinimaxTreeNode* node = new MinimaxTreeNode;
     node->player = (layer % 2 == 0) ? MAXPLAYER : MINPLAYER;
     node->action = action;
     // Set node's game state to the given one.
-    copyGameState(gameState, node->gameState);
+    node->gameState = game.board.state;
 
     // If layer is even or 0, then the current player is this, next player is the opponent
     // If the layer is odd, then the current palyer is opponent, next player is this player
-    char currentPlayer = (layer % 2 == 0) ? this->mark : this->opponentMark;
+    // game.currentPlayer alternates the same way as moves are made.
     // Create nodes for each action of the current player
     // If validActions is empty, then no successors are created
-    std::list<moveRCPair> validActions = getValidActions(gameState);
-
-    if(layer == 0 || validActions.size() == 0) {    // final layer or no more actions, so stop
-        return node;
-    }
-    else {  // Generate successors
-        for(moveRCPair move : validActions) {
-            // Copy game state
-            char nextGameState[3][3];
-            copyGameState(gameState, nextGameState);
-            // Create new game state
-            nextGameState[move.row][move.column] = currentPlayer;
-            MinimaxTreeNode* successor = createGameTree(move, nextGameState, layer - 1);
-            node->successors.push_back(successor);
-        }
+    typename Board::MoveSet validActions = getValidActions(game.board.state);
 
-        return node;
+    if(layer == 0 || validActions.empty()) {    // final layer or no more actions, so stop
+        return;
     }
-}
 
-void AIPlayerMinimax::deleteTree(MinimaxTreeNode* root) {
-    if(root != NULL) {
-        for(MinimaxTreeNode* successor : root->successors) {
-            deleteTree(successor);
+    // Find the moves to keep first, so their nodes can be allocated together
+    moveRCPair moves[Board::CELLS];
+    int numOfMoves = 0;
+    // Canonical hashes of the successors so far.  A move symmetric to one of them has the same value.
+    uint64_t siblings[Board::CELLS];
+    int numOfSiblings = 0;
+    for(moveRCPair move : validActions) {
+        if(this->useSymmetry) {
+            game.makeMove(move.row, move.column);
+            uint64_t canonical = game.boardHashes[game.canonicalSymmetry()];
+            game.undoMove();
+            if(std::find(siblings, siblings + numOfSiblings, canonical) != siblings + numOfSiblings) continue;
+            siblings[numOfSiblings++] = canonical;
         }
-        root->successors.clear();
-        delete root;
-        root = NULL;
+        moves[numOfMoves++] = move;
+    }
+
+    // Generate successors, creating each new game state in place, then taking the move back
+    node->successors = &this->nodePool[this->nodePool.allocate(numOfMoves)];
+    node->numOfSuccessors = numOfMoves;
+    for(int i = 0; i < numOfMoves; i++) {
+        game.makeMove(moves[i].row, moves[i].column);
+        growTree(node->successors + i, moves[i], game, layer - 1);
+        game.undoMove();
     }
 }
 
-void AIPlayerMinimax::postOrderTraversal(MinimaxTreeNode* root, int layer) {
+template<class Board>
+void AIPlayerMinimax<Board>::deleteTree() {
+    this->nodePool.release();
+}
+
+template<class Board>
+void AIPlayerMinimax<Board>::postOrderTraversal(Node* root, int layer) {
     if(root != NULL) {
-        for(MinimaxTreeNode* successor : root->successors) {
-            postOrderTraversal(successor, layer + 1);
+        for(int i = 0; i < root->numOfSuccessors; i++) {
+            postOrderTraversal(root->successors + i, layer + 1);
         }
         std::cout << "Layer: " << layer << ", Player: " << root->player << ", Node: " << root->action.row << "," << root->action.column << std::endl;   
     }
-}
\ No newline at end of file
+}
+
+#define INSTANTIATE_AIPLAYERMINIMAX(Board) template class AIPlayerMinimax<Board>;
+FOR_EACH_GAME(INSTANTIATE_AIPLAYERMINIMAX)
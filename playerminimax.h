@@ -8,76 +8,220 @@
 #ifndef AIPLAYERMINIMAX
 #define AIPLAYERMINIMAX
 
-#include <list>
+#include <chrono>
+#include <type_traits>
+#include <vector>
 
+#include "nodearena.h"
 #include "player.h"
+#include "transposition.h"
+#include "tablebase.h"
+#include "moveordering.h"
+#include "threats.h"
+#include "evaluation.h"
+#include "batcheval.h"
 
 #define MAXPLAYER true
 #define MINPLAYER false
 
+// Drivers of the in-place search, for AIPlayerMinimax::searchMode
+const int SEARCH_ALPHABETA = 0; // One search with the full window
+const int SEARCH_PVS = 1;       // Moves after the first are searched with a null window first, and again if they are better
+const int SEARCH_MTDF = 2;      // Null window searches at the root, closing in on the value from a first guess
+
 // A node in a minimax search tree.
+template<class Board>
 struct MinimaxTreeNode {
     int player = -1;    // -1 by default.  Given value MAXPLAYER or MINPLAYER
-    char gameState[3][3] = BLANK_BOARD;  // A 3x3 array like the game board.
+    Board gameState;  // The game state, like the game board.
     moveRCPair action;  // The action that lead to the game state in this node.
-    std::list<MinimaxTreeNode*> successors;   // A list of pointers to child nodes.
+    MinimaxTreeNode* successors = NULL;   // The first child node.  The child nodes are contiguous.
+    int numOfSuccessors = 0;
 };
 
-class AIPlayerMinimax: public Player {
+template<class Board>
+class AIPlayerMinimax: public BoardPlayer<Board> {
     public:
-        // Max depth of search.  0 for the limit, which is 9.
+        typedef MinimaxTreeNode<Board> Node;
+
+        // Max depth of search.  0 for the limit, which is the number of boxes.
         int depthLimit = 0;
         // The opponent's mark
         char opponentMark;
         // A handy variable to hold the number of nodes in the minimax tree
         int treeSize = 0;
+        // The nodes of createGameTree(), kept from move to move so their blocks are reused
+        NodeArena<Node> nodePool;
+        // Search the game in place with negamaxSearch() instead of building a tree with createGameTree().
+        // Memory only grows with the depth, and Ultimate Tic Tac Toe is too big for a tree.
+        bool inPlace = true;
+        // Look up positions reached through another order of moves.  The table is only used in place.
+        bool useTable = true;
+        // Keep the table from turn to turn instead of clearing it before each search
+        bool persistTable = true;
+        // Values, bounds, and best moves of searched positions.  Helper threads search with this one.
+        TranspositionTable table;
+        // Positions found in the table in the last search
+        long tableHits = 0;
+        // Treat rotated and mirrored positions as one, in the table and among the successors of the game tree
+        bool useSymmetry = true;
+        // If set, moves of the 3x3 game are looked up here instead of searched
+        const Tablebase* tablebase = NULL;
+        // Play wins, blocks, and forks found by forcedMove() without searching
+        bool useThreats = true;
+        // Milliseconds to search each move by iterative deepening, up to depthLimit.  0 searches to depthLimit at once.
+        int timeBudget = 0;
+        // Time when the current iterative deepening search must stop
+        std::chrono::steady_clock::time_point deadline;
+        // Set when the deadline passes, so the search unwinds and the unfinished iteration is thrown away
+        bool timedOut = false;
+        // Best move of the last completed iteration, searched first at the root, or -1, -1
+        moveRCPair rootMove = std::make_pair(-1, -1);
+        // Killers, history, and cutoff counts.  Set ordering.moveOrdering to pick the heuristics.
+        MoveOrderer<Board> ordering;
+        // Layers searched for the last move, for the effective branching factor
+        int searchedDepth = 0;
+        // Threads that search the moves of the root at once.  1 searches serially.  Only used in place.
+        int threads = 1;
+        // SEARCH_ driver of the in-place search.  MTD(f) searches on one thread.
+        int searchMode = SEARCH_ALPHABETA;
+        // Value of the last move chosen, the first guess of MTD(f)
+        int lastValue = 0;
+        // Searches of mtdfSearch() in the last search for the first move of the value, after a fail high below it
+        long mtdfResearches = 0;
+        // Score the leaves below each position one layer from the depth limit in batches with evaluateBatch(), instead of making each move
+        bool batchLeaves = false;
 
         // Constructor
-        AIPlayerMinimax(int code, char mark, int depthLimit): Player(code, mark) {
-            this->depthLimit = (depthLimit <= 0) ? 9 : depthLimit;
+        AIPlayerMinimax(int code, char mark, int depthLimit, int timeBudget = 0): BoardPlayer<Board>(code, mark) {
+            this->depthLimit = (depthLimit <= 0) ? Board::CELLS : depthLimit;
+            this->timeBudget = (timeBudget < 0) ? 0 : timeBudget;
             this->opponentMark = (this->mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK;
 
             // Introduction
 #if defined(VERBOSE)
-            std::cout << "Introducing Player " << this->mark << ", who is a Minimax algorithm AI of search depth " << this->depthLimit << std::endl;
+            std::cout << "Introducing Player " << this->mark << ", who is a Minimax algorithm AI of search depth " << this->depthLimit;
+            if(this->timeBudget > 0) std::cout << " and " << this->timeBudget << " ms per move";
+            std::cout << std::endl;
 #endif  // VERBOSE
         };
 
         ~AIPlayerMinimax() {
+            for(AIPlayerMinimax* helper : this->helpers) delete helper;
+            this->helpers.clear();
             this->depthLimit = 0;
             this->opponentMark = 0;
             this->treeSize = 0;
         }
 
         // Use minimax and a game tree to choose the best move.
-        moveRCPair chooseMove(Game* game);
+        moveRCPair chooseMove(Game<Board>* game);
+
+        /**
+         * Score every move of @param game, with this player to move, in one in-place search to depthLimit.
+         * Each move of the root is searched with the full window, so its value is exact instead of a bound,
+         * and the moves below share the table and ordering.
+         * The principal variations follow the best moves stored in the table, so they are only the first move without useTable.
+         */
+        std::vector<MoveAnalysis> analyze(Game<Board>* game);
 
         /**
          * Perform minimax search on the game tree of the given root and depth.
-         * Uses alpha-beta pruning.
+         * Uses alpha-beta pruning.  Successors below the root are searched in the order of ordering.
          * Returns a pair containing the optimal move and its heuristic value.
          */
-        std::pair<moveRCPair, int> minimaxSearch(MinimaxTreeNode* node, int depth, int alpha, int beta, bool maxPlayer, moveRCPair action);
+        std::pair<moveRCPair, int> minimaxSearch(Node* node, int depth, int alpha, int beta, bool maxPlayer, moveRCPair action);
+
+        /**
+         * Perform the same search as minimaxSearch() without a tree, in negamax form.
+         * Moves are made and taken back on @param game, so memory only grows with the depth.
+         * Values are for the player to move: @param color is 1 if it is this player and -1 if it is the opponent,
+         * so the root returns the same move and value as minimaxSearch().
+         * With searchMode SEARCH_PVS, moves after the first are only searched with the full window if a null window search finds them better.
+         * If useTable is set, positions in the table are not searched again, and the stored best move is tried first.
+         * The other moves below the root are searched in the order of ordering.  The root keeps its order so ties go the same way.
+         * With useSymmetry, a position is looked up by its canonical form.
+         * With batchLeaves, the moves one layer from the depth limit are not made: their boards are scored BATCH_WIDTH at a time,
+         * and looked at in order as if searched.
+         * Stops early, setting timedOut, once the deadline passes if timeBudget is set.
+         * Counts each visited state in treeSize.
+         */
+        std::pair<moveRCPair, int> negamaxSearch(Game<Board>& game, int depth, int alpha, int beta, int color, moveRCPair action);
+
+        /**
+         * Search @param game in place to 1, 2, 3, and more layers, up to @param maxDepth, until timeBudget runs out.
+         * Each iteration searches the best move of the last one first.  The transposition table carries the rest of the ordering.
+         * Returns the move and value of the deepest completed iteration.  The first iteration always completes.
+         */
+        std::pair<moveRCPair, int> iterativeDeepeningSearch(Game<Board>& game, int maxDepth);
+
+        /**
+         * Perform the same search as negamaxSearch() from the root of @param game with threads threads.
+         * The first move is searched alone for a bound, and then the threads take the other moves one at a time,
+         * each searching with the best value found by any of them.  The threads share the transposition table.
+         * A move before the best so far is searched with a window one lower, so ties are settled as in the serial search,
+         * and the same move and value are returned.
+         */
+        std::pair<moveRCPair, int> parallelSearch(Game<Board>& game, int depth, moveRCPair action);
+
+        /**
+         * Perform MTD(f) from the root of @param game: null window searches of negamaxSearch(), each raising or lowering
+         * the bounds on the value, starting from @param guess, until they meet.
+         * If the last search to fail high was not at the value, one more finds the first move of that value,
+         * so the same move and value are returned as by one full window search.  Relies on the table to search few states again.
+         */
+        std::pair<moveRCPair, int> mtdfSearch(Game<Board>& game, int depth, int guess, moveRCPair action);
+
+        // Search the root of @param game with the driver of searchMode, serially or in parallel by threads.
+        // @param guess is the expected value, for MTD(f).
+        std::pair<moveRCPair, int> rootSearch(Game<Board>& game, int depth, int guess, moveRCPair action);
 
         /**
          * Return a heuristic based on the node's game state.
          * Could always be better.
          */
-        int evalFunction(MinimaxTreeNode* node);
+        int evalFunction(Node* node);
+
+        // Return the heuristic of the given game state.
+        int evalFunction(const Board& gameState);
+
+        // Return the same heuristic of the game's board, from its line counts if it keeps them.
+        int evalFunction(const Game<Board>& game);
+
+        // Put the heuristics of @param n game states into @param scores, with SIMD where evaluateBatch() has it.
+        void evalFunction(const Board* gameStates, int n, int* scores);
 
         /**
          * Create a game tree of the given depth (layers = 2 * depth) 
          * and return the root node.  @param action is the initial action, 
-         * and @param gameState is the initial game state.
+         * and @param game holds the initial game state with this player to move.
+         * Successors are made and taken back on @param game in place.
+         * With useSymmetry, a move whose successor is symmetric to an earlier one's is left out.
+         * The nodes come from nodePool.
          */
-        MinimaxTreeNode* createGameTree(moveRCPair action, char gameState[3][3], int layer);
+        Node* createGameTree(moveRCPair action, Game<Board>& game, int layer);
 
         /**
-         * Delete the game tree.
+         * Delete the game tree, releasing every node of nodePool at once.
          */
-        void deleteTree(MinimaxTreeNode* root);
+        void deleteTree();
+
+        void postOrderTraversal(Node* root, int layer);
+
+    private:
+        // The player whose table this helper searches with, or NULL if this is not a helper
+        AIPlayerMinimax* owner = NULL;
+        // Players searching on the other threads of parallelSearch(), kept so their history carries over
+        std::vector<AIPlayerMinimax*> helpers;
+
+        // Constructor of a helper of @param owner, without a table of its own
+        AIPlayerMinimax(AIPlayerMinimax* owner);
+
+        // Fill in @param node, reached by @param action, and its successors below it for @param layer more layers.
+        void growTree(Node* node, moveRCPair action, Game<Board>& game, int layer);
 
-        void postOrderTraversal(MinimaxTreeNode* root, int layer);
+        // Add the best moves stored in the table from @param game to @param pv, up to @param depth moves, and take them back.
+        void principalVariation(Game<Board>& game, int depth, std::vector<moveRCPair>& pv);
 };
 
 
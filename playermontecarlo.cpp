@@ -10,273 +10,616 @@
 #endif  // defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
 
 #include <cmath>
-#include <stdlib.h>
-#include <time.h>
 #include <iterator>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
 
 #include "playermontecarlo.h"
 
-MonteCarloTreeNode* createNode(bool player, char gameState[3][3], moveRCPair action, MonteCarloTreeNode* predecessor, int depth) {
-    MonteCarloTreeNode* node = new MonteCarloTreeNode;
-    node->player = player;
-    copyGameState(gameState, node->gameState);
-    node->action = action;
-    node->depth = depth;
-    node->predecessor = predecessor;
-    node->untriedActions = getValidActions(node->gameState);
+template<class Board>
+uint32_t MonteCarloTree<Board>::createNode(bool player, const Board& gameState, moveRCPair action, uint32_t predecessor) {
+    uint32_t index = this->nodes.allocate();
+    this->setNode(index, player, gameState, action, predecessor);
 
-    return node;
+    if(this->root == NO_NODE) this->root = index;
+    return index;
+}
+
+template<class Board>
+void MonteCarloTree<Board>::setNode(uint32_t index, bool player, const Board& gameState, moveRCPair action, uint32_t predecessor) {
+    Node& node = this->nodes[index];
+    node.player = player;
+    node.gameState = gameState;
+    node.actionRow = action.row;
+    node.actionCol = action.column;
+    node.predecessor = predecessor;
+    node.untriedActions = getValidActions(node.gameState);
+}
+
+template<class Board>
+void MonteCarloTree<Board>::clear() {
+    this->nodes.release();
+    this->root = NO_NODE;
+}
+
+template<class Board>
+void MonteCarloTree<Board>::createScion(uint32_t keep) {
+    if(keep == NO_NODE) {
+        this->clear();
+        return;
+    }
+
+    this->scion.release();
+    uint32_t first = this->scion.allocate();
+    this->scion[first] = this->nodes[keep];
+    this->scion[first].predecessor = NO_NODE;
+    this->copySuccessors(keep, first);
+    this->nodes.swap(this->scion);
+    this->scion.release();
+    this->root = first;
+}
+
+template<class Board>
+void MonteCarloTree<Board>::copySuccessors(uint32_t from, uint32_t to) {
+    int numOfSuccessors = this->scion[to].numOfSuccessors;
+    if(numOfSuccessors == 0) return;
+
+    // Copy the successors together, so they stay contiguous, then their descendents
+    uint32_t source = this->nodes[from].successors;
+    uint32_t first = this->scion.allocate(numOfSuccessors);
+    for(int i = 0; i < numOfSuccessors; i++) {
+        this->scion[first + i] = this->nodes[source + i];
+        this->scion[first + i].predecessor = to;
+    }
+    this->scion[to].successors = first;
+    for(int i = 0; i < numOfSuccessors; i++) this->copySuccessors(source + i, first + i);
 }
 
-moveRCPair lightPlayout(char player, char gameState[3][3]) {
-    std::list<moveRCPair> possibleActions = getValidActions(gameState);
+template<class Board>
+moveRCPair lightPlayout(char player, const Board& gameState, Xoshiro256& random) {
+    typename Board::MoveSet possibleActions = getValidActions(gameState);
     // Randomly pick one
-    srand(time(NULL));
-    std::list<moveRCPair>::iterator it = possibleActions.begin();
-    int randomIndex = rand() % possibleActions.size();
-    for(int i = 0; i < randomIndex; i++) it++;
-    moveRCPair nextAction = *it;
+    int randomIndex = random.below(possibleActions.size());
+    moveRCPair nextAction = possibleActions.nth(randomIndex);
 
     return nextAction;
 }
 
-float ucb(MonteCarloTreeNode* node) {
+template<class Board>
+float ucb(const MonteCarloTreeNode<Board>& node, int predNumOfVisits) {
     float value = 1;
 
     // Prevent divide by zero
-    float ownNumOfVisits = (node->numOfVisits == 0) ? 0.0000001 : node->numOfVisits;
-    float predNumOfVisits = (node->predecessor->numOfVisits == 0) ? 1 : node->predecessor->numOfVisits;
-    value = ((node->numOfWins + node->numOfDraws) / (ownNumOfVisits)) + (std::sqrt(2) * std::sqrt(std::log(predNumOfVisits) / ownNumOfVisits));
+    int numOfVisits = node.numOfVisits.load(std::memory_order_relaxed);
+    float ownNumOfVisits = (numOfVisits == 0) ? 0.0000001 : numOfVisits;
+    float predVisits = (predNumOfVisits == 0) ? 1 : predNumOfVisits;
+    int numOfWinsAndDraws = node.numOfWins.load(std::memory_order_relaxed) + node.numOfDraws.load(std::memory_order_relaxed);
+    value = (numOfWinsAndDraws / (ownNumOfVisits)) + (std::sqrt(2) * std::sqrt(std::log(predVisits) / ownNumOfVisits));
 
     return value;
 }
 
-bool isTerminalNode(MonteCarloTreeNode* node) {
-    bool result = false;
+template<class Board>
+float promise(const MonteCarloTreeNode<Board>& node) {
+    // Prevent divide by zero
+    float numOfVisits = (node.numOfVisits == 0) ? 0.0000001 : node.numOfVisits.load();
+    // (1/sqrt(min of simulated moves to win)) * (2*numOfWins + numOfDraws) / numOfVisits
+    return (1 / std::sqrt(node.minSimMovesToWin.load())) * (2 * node.numOfWins + node.numOfDraws) / numOfVisits;
+}
 
-    int filled = 0;
-    for(int i = 0; i < ROWS * COLS; i++) {
-        if(node->gameState[(int)(i / 3)][i % 3] != CLEAR) filled++;
-    }
+template<class Board>
+bool isTerminalNode(const MonteCarloTreeNode<Board>& node) {
+    return terminalState(node.gameState) != ONGOING;
+}
 
-    if(filled == ROWS * COLS || playerWins(PLAYER_X_MARK, node->gameState) || playerWins(PLAYER_O_MARK, node->gameState)) result = true;
+template<class Board>
+moveRCPair AIPlayerMonteCarlo<Board>::chooseMove(Game<Board>* game) {
+    moveRCPair move;
 
-    return result;
-}
+    if constexpr(std::is_same<Board, TicTacToe>::value) {
+        const TablebaseEntry* entry = (this->tablebase != NULL) ? this->tablebase->lookup(game->board.state, this->code) : NULL;
+        if(entry != NULL && entry->bestMoves != 0) {
+            // The tree no longer follows the game, so start a new one if it is needed again
+            this->clearTrees();
 
-void deleteTree(MonteCarloTreeNode* root) {
-    if(root != NULL) {
-        for(MonteCarloTreeNode* successor : root->successors) {
-            deleteTree(successor);
+            move = Tablebase::pickMove(entry);
+#if defined(VERBOSE) || defined(DEBUG)
+            std::cout << "\tFound optimal move in the tablebase: " << move.row << ", " << move.column << " of value " << (int)entry->value << std::endl;
+#elif defined(MINIMAL_VERBOSE)
+            std::cout << game->turns << " " << this->mark << ":" << move.row << "," << move.column << std::endl;
+#endif
+            return move;
         }
-        root->successors.clear();
-        root->untriedActions.clear();
+    }
 
-        delete root;
-        root = NULL;
+    if(this->useThreats) {
+        ForcedMove forced = forcedMove(game->board.state, this->mark, this->opponentMark);
+        if(forced.kind != THREAT_NONE) {
+            // As with the tablebase, the tree no longer follows the game
+            this->clearTrees();
+#if defined(VERBOSE) || defined(DEBUG)
+            std::cout << "\tFound forced move (" << THREAT_NAMES[forced.kind] << "): " << forced.move.row << ", " << forced.move.column << std::endl;
+#elif defined(MINIMAL_VERBOSE)
+            std::cout << game->turns << " " << this->mark << ":" << forced.move.row << "," << forced.move.column << std::endl;
+#endif
+            return forced.move;
+        }
     }
+
+    int symmetry = this->search(game);
+    // From the root, find the immediate child with the greatest promise and get its action.
+    // With more threads, each move is rated by its results in every tree.
+    const Node& root = this->tree[this->tree.root];
+    float max = -1;
+    uint32_t mostPromising = this->tree.root;
+    for(uint32_t successor = root.successors; successor < root.successors + root.numOfSuccessors; successor++) {
+        Node merged = this->mergedSuccessor(successor);
+        float value = promise(merged);
+#if defined(DEBUG)
+        std::cout << "Action: " << (int)merged.actionRow << "," << (int)merged.actionCol << "\tValue: " << value << "\tMin exp moves to win: " << merged.minSimMovesToWin << "\tVisits: " << merged.numOfVisits << std::endl;
+#endif  // defined(VERBOSE) || defined(DEBUG)
+        if(value > max) {
+            max = value;
+            mostPromising = successor;
+        }
+    }
+    // Map the action on the tree's state back to the game
+    moveRCPair action = this->tree[mostPromising].action();
+    move = (symmetry > 0 && mostPromising != this->tree.root) ? untransformMove<Board>(action, symmetry) : action;
+#if defined(DEBUG)
+    std::cout << "Root visits: " << root.numOfVisits << std::endl;
+#endif  // DEBUG
+    // The helpers' roots follow the move too
+    Board next = game->board.state;
+    next.set(move.row, move.column, this->mark);
+    for(AIPlayerMonteCarlo* helper : this->helpers) {
+        int helperSymmetry;
+        helper->tree.createScion(helper->tree.empty() ? NO_NODE : helper->findSuccessor(next, helperSymmetry));
+    }
+    // Move the root to the most promising node and delete the rest
+    this->tree.createScion(mostPromising);
+#if defined(VERBOSE) || defined(DEBUG)
+    std::cout << "\tFound optimal move: " << move.row << ", " << move.column << " of value " << max << std::endl;
+#elif defined(MINIMAL_VERBOSE)
+    std::cout << game->turns << " " << this->mark << ":" << move.row << "," << move.column << std::endl;
+#endif
+    return move;
 }
 
-void createScion(MonteCarloTreeNode* root, MonteCarloTreeNode* keep) {
-    if(root != NULL && root != keep) {
-        for(MonteCarloTreeNode* successor : root->successors) {
-            createScion(successor, keep);
+template<class Board>
+int AIPlayerMonteCarlo<Board>::search(Game<Board>* game) {
+    int symmetry;
+    std::vector<std::thread> workers;
+    if(this->threads > 1 && this->parallelMode == PARALLEL_TREE) {
+        // The threads grow this tree together, each with a random sequence of its own
+        for(AIPlayerMonteCarlo* helper : this->helpers) helper->tree.clear();
+        symmetry = this->moveRoot(game);
+        this->tree.reserve((uint64_t)this->threads * this->iterations * Board::CELLS);
+        std::vector<Xoshiro256> randoms;
+        for(int t = 0; t < this->threads - 1; t++) randoms.emplace_back(this->random.next());
+        for(int t = 0; t < this->threads - 1; t++) {
+            workers.emplace_back([this, &randoms, t]() { this->iterate(this->iterations, randoms[t], this->virtualLoss); });
         }
-        root->successors.clear();
-        root->untriedActions.clear();
+        this->iterate(this->iterations, this->random, this->virtualLoss);
+        for(std::thread& worker : workers) worker.join();
+    }
+    else if(this->threads > 1 && this->parallelMode == PARALLEL_LEAF) {
+        // This thread grows the tree, and the others wait for each of its leaves to play out from
+        for(AIPlayerMonteCarlo* helper : this->helpers) helper->tree.clear();
+        symmetry = this->moveRoot(game);
+        LeafBatch batch;
+        for(int t = 1; t < this->threads; t++) {
+            uint64_t seed = this->random.next();
+            workers.emplace_back([this, &batch, t, seed]() {
+                Xoshiro256 random(seed);
+                this->playLeaves(batch, t, random);
+            });
+        }
+        this->iterate(this->iterations, this->random, 0, &batch);
+        {
+            std::lock_guard<std::mutex> guard(batch.lock);
+            batch.stop = true;
+        }
+        batch.started.notify_all();
+        for(std::thread& worker : workers) worker.join();
+    }
+    else {
+        // The helpers grow their trees on the other threads while this one grows its own
+        while((int)this->helpers.size() < this->threads - 1) this->helpers.push_back(new AIPlayerMonteCarlo(this));
+        for(int t = 0; t < this->threads - 1; t++) {
+            AIPlayerMonteCarlo* helper = this->helpers[t];
+            helper->iterations = this->iterations;
+            helper->useSymmetry = this->useSymmetry;
+            helper->leafPlayouts = this->leafPlayouts;
+            workers.emplace_back([helper, game]() { helper->searchTree(game); });
+        }
+        symmetry = this->searchTree(game);
+        for(std::thread& worker : workers) worker.join();
+    }
 
-        delete root;
-        root = NULL;
+#if defined(VERBOSE) || defined(DEBUG)
+    size_t nodes = this->tree.size();
+    size_t peak = this->tree.peak();
+    size_t bytes = this->tree.memoryUsed();
+    for(int t = 0; t < this->threads - 1 && this->parallelMode == PARALLEL_ROOT; t++) {
+        nodes += this->helpers[t]->tree.size();
+        peak += this->helpers[t]->tree.peak();
+        bytes += this->helpers[t]->tree.memoryUsed();
     }
-    else if(root == keep) {
-        root->predecessor = NULL;
+    std::cout << "\tMonte Carlo AI tree has " << nodes << " nodes (peak " << peak << ") in " << bytes / 1024 << " KiB";
+    if(this->threads > 1) std::cout << ", " << ((this->parallelMode == PARALLEL_ROOT) ? "over " : "shared by ") << this->threads << " threads";
+    if(this->leafPlayouts > 1) std::cout << ", " << this->leafPlayouts << " playouts per leaf";
+    std::cout << std::endl;
+#endif  // defined(VERBOSE) || defined(DEBUG)
+    return symmetry;
+}
+
+template<class Board>
+typename AIPlayerMonteCarlo<Board>::Node AIPlayerMonteCarlo<Board>::mergedSuccessor(uint32_t successor) {
+    Node merged = this->tree[successor];
+    for(int t = 0; t < this->threads - 1 && t < (int)this->helpers.size() && this->parallelMode == PARALLEL_ROOT; t++) {
+        AIPlayerMonteCarlo* helper = this->helpers[t];
+        if(helper->tree.empty()) continue;
+        int symmetry;
+        uint32_t match = helper->findSuccessor(merged.gameState, symmetry);
+        if(match == NO_NODE) continue;
+        const Node& node = helper->tree[match];
+        merged.numOfVisits += node.numOfVisits;
+        merged.numOfWins += node.numOfWins;
+        merged.numOfDraws += node.numOfDraws;
+        merged.numOfLosses += node.numOfLosses;
+        merged.minSimMovesToWin = std::min(merged.minSimMovesToWin.load(), node.minSimMovesToWin.load());
     }
+    return merged;
 }
 
-moveRCPair AIPlayerMonteCarlo::chooseMove(Game* game) {
-    moveRCPair move;
+template<class Board>
+uint32_t AIPlayerMonteCarlo<Board>::findSuccessor(const Board& state, int& symmetry) {
+    const Node& root = this->tree[this->tree.root];
+    for(uint32_t successor = root.successors; successor < root.successors + root.numOfSuccessors; successor++) {
+        const Board& successorState = this->tree[successor].gameState;
+        symmetry = (this->useSymmetry) ? symmetryBetween(state, successorState) : (gameStatesAreEqual(state, successorState) ? 0 : -1);
+        if(symmetry >= 0) return successor;
+    }
+    symmetry = -1;
+    return NO_NODE;
+}
+
+template<class Board>
+void AIPlayerMonteCarlo<Board>::clearTrees() {
+    this->tree.clear();
+    for(AIPlayerMonteCarlo* helper : this->helpers) helper->tree.clear();
+}
+
+template<class Board>
+int AIPlayerMonteCarlo<Board>::searchTree(Game<Board>* game) {
+    int symmetry = this->moveRoot(game);
+    this->iterate(this->iterations, this->random, 0);
+    return symmetry;
+}
+
+template<class Board>
+int AIPlayerMonteCarlo<Board>::moveRoot(Game<Board>* game) {
+    // Find the current game state in the tree
+    // Update the game tree so that the root is the current game state
+    // The tree may hold a symmetric state instead, so track the symmetry that maps the game onto it
+    int symmetry = -1;
+    if(!this->tree.empty()) {
+        symmetry = (this->useSymmetry) ? symmetryBetween(game->board.state, this->tree[this->tree.root].gameState) : -1;
+        if(gameStatesAreEqual(this->tree[this->tree.root].gameState, game->board.state) || symmetry >= 0) {    // If the root already matches the current game state (first play)
+            // Do nothing
+        }
+        else {  // If the root does not match the current game state
+            // If the root has no successors (the node of the previous action was unexpanded and not very promising), do one expansion of the root
+            if(this->tree[this->tree.root].numOfSuccessors == 0) {
+                this->expansion(this->tree.root);
+            }
+
+            // Find it in the immediate successors
+            uint32_t match = this->findSuccessor(game->board.state, symmetry);
+            // Without a match, the tree is emptied and started again
+            this->tree.createScion(match);
+        }
+    }
 
     // Init the tree if it doesn't exist yet
-    if(this->tree == NULL) {
+    if(this->tree.empty()) {
         // Create root node from given game
         // The player of this node is the one that just played
-        bool currentPlayer = ((game->currentPlayer == PLAYER_X_CODE && this->code == PLAYER_X_CODE) 
+        bool currentPlayer = ((game->currentPlayer == PLAYER_X_CODE && this->code == PLAYER_X_CODE)
                                 || (game->currentPlayer == PLAYER_O_CODE && this->code == PLAYER_O_CODE)) ? OPPONENT : SELF;
         moveRCPair placeholder = std::make_pair(-1, -1);
-        this->tree = createNode(currentPlayer, game->board.grid, placeholder, NULL, 0);
-    }
-
-    // Find the current game state in the tree
-    // Update the game tree so that the root is the current game state
-    if(gameStatesAreEqual(this->tree->gameState, game->board.grid)) {    // If the root already matches the current game state (first play)
-        // Do nothing
+        this->tree.createNode(currentPlayer, game->board.state, placeholder, NO_NODE);
+        symmetry = (this->useSymmetry) ? 0 : -1;
     }
-    else {  // If the root does not match the current game state
-        // Check if the current node has immediate successors
-        bool hasSuccessors = !this->tree->successors.empty();
 
-        // If the root has no successors (the node of the previous action was unexpanded and not very promising), do one expansion of the root
-        if(!hasSuccessors) {
-            this->expansion(this->tree);
-        }
+    return symmetry;
+}
 
-        // Find it in the immediate successors
-        MonteCarloTreeNode* match = NULL;
-        for(MonteCarloTreeNode* s : this->tree->successors) {
-            if(gameStatesAreEqual(game->board.grid, s->gameState)) {
-                match = s;
-                break;
+template<class Board>
+void AIPlayerMonteCarlo<Board>::iterate(int iterations, Xoshiro256& random, int virtualLoss, LeafBatch* batch) {
+    // Do MCTS for the given number of iterations
+    for(int i = 0; i < iterations; i++) {
+        // Select a leaf
+        uint32_t leaf = this->selection(this->tree.root, &ucb, virtualLoss);
+        // Try expansion.  The new node is on the path too.
+        uint32_t newNode = this->expansion(leaf, random);
+        if(virtualLoss != 0 && newNode != leaf) this->tree[newNode].numOfVisits.fetch_add(virtualLoss, std::memory_order_relaxed);
+        if(batch != NULL) {
+            // Hand the leaf to the other threads, play this thread's share, and add theirs once they are done
+            {
+                std::lock_guard<std::mutex> guard(batch->lock);
+                batch->leaf = newNode;
+                batch->results = PlayoutResults();
+                batch->pending = this->threads - 1;
+                batch->leaves++;
             }
+            batch->started.notify_all();
+            PlayoutResults results = this->simulateBatch(newNode, &lightPlayout, this->shareOfPlayouts(0), random);
+            {
+                std::unique_lock<std::mutex> guard(batch->lock);
+                batch->finished.wait(guard, [batch]() { return batch->pending == 0; });
+                results.add(batch->results);
+            }
+            this->backpropagation(newNode, results, virtualLoss);
+        }
+        else if(this->leafPlayouts > 1) {
+            // Simulate the batch and backpropagate its results together
+            this->backpropagation(newNode, this->simulateBatch(newNode, &lightPlayout, this->leafPlayouts, random), virtualLoss);
+        }
+        else {
+            // Simulate or get terminal node result
+            int result = this->simulation(newNode, &lightPlayout, random);
+            // Backpropagate result
+            this->backpropagation(newNode, result, virtualLoss);
         }
-        createScion(this->tree, match);
-        this->tree = match;
     }
+}
 
-    // Do MCTS for the given number of iterations
-    for(int i = 0; i < this->iterations; i++) {
-        // Select a leaf
-        MonteCarloTreeNode* leaf = this->selection(this->tree, &ucb);
-        // Try expansion
-        MonteCarloTreeNode* newNode = this->expansion(leaf);
-        // Simulate or get terminal node result
-        int result = this->simulation(newNode, lightPlayout);
-        // Backpropagate result
-        this->backpropagation(newNode, result);
+template<class Board>
+void AIPlayerMonteCarlo<Board>::playLeaves(LeafBatch& batch, int thread, Xoshiro256& random) {
+    int leaves = 0;
+    while(true) {
+        // Wait for the next leaf
+        std::unique_lock<std::mutex> guard(batch.lock);
+        batch.started.wait(guard, [&batch, leaves]() { return batch.stop || batch.leaves != leaves; });
+        if(batch.stop) return;
+        leaves = batch.leaves;
+        uint32_t leaf = batch.leaf;
+        guard.unlock();
+
+        // The tree does not change until every thread is done with the leaf
+        PlayoutResults results = this->simulateBatch(leaf, &lightPlayout, this->shareOfPlayouts(thread), random);
+
+        guard.lock();
+        batch.results.add(results);
+        if(--batch.pending == 0) batch.finished.notify_one();
     }
-    // From the root, find the immediate child with the greatest promise and get its action.
-    float max = -1;
-    MonteCarloTreeNode* mostPromising = this->tree;
-    for(MonteCarloTreeNode* successor : this->tree->successors) {
-        // Prevent divide by zero
-        float numOfVisits = (successor->numOfVisits == 0) ? 0.0000001 : successor->numOfVisits;
-        // Calculate value for best action: (1/sqrt(min of simulated moves to win)) * (2*numOfWins + numOfDraws) / numOfVisits
-        float value = (1 / std::sqrt(successor->minSimMovesToWin)) * (2 * successor->numOfWins + successor->numOfDraws) / numOfVisits;
-#if defined(DEBUG)
-        std::cout << "Action: " << successor->action.row << "," << successor->action.column << "\tValue: " << value << "\tMin exp moves to win: " << successor->minSimMovesToWin << "\tVisits: " << successor->numOfVisits << std::endl;    
-#endif  // defined(VERBOSE) || defined(DEBUG)
-        if(value > max) {
-            max = value;
-            mostPromising = successor;
+}
+
+template<class Board>
+std::vector<MoveAnalysis> AIPlayerMonteCarlo<Board>::analyze(Game<Board>* game) {
+    std::vector<MoveAnalysis> analysis;
+    if(terminalState(game->board.state) != ONGOING) return analysis;
+    this->search(game);
+
+    const Node& root = this->tree[this->tree.root];
+    for(moveRCPair move : getValidActions(game->board.state)) {
+        MoveAnalysis entry;
+        entry.move = move;
+        entry.pv.push_back(move);
+        // With useSymmetry, the move's node may hold a symmetric state, and the moves below it map back by the same symmetry
+        Board next = game->board.state;
+        next.set(move.row, move.column, this->mark);
+        int symmetry;
+        uint32_t node = this->findSuccessor(next, symmetry);
+        // Unvisited moves score 0
+        if(node != NO_NODE) {
+            entry.score = promise(this->mergedSuccessor(node));
+            // The principal variation follows the most visited replies
+            for(const Node* current = &this->tree[node]; current->numOfSuccessors > 0;) {
+                const Node* mostVisited = &this->tree[current->successors];
+                for(uint32_t s = current->successors; s < current->successors + current->numOfSuccessors; s++) {
+                    if(this->tree[s].numOfVisits > mostVisited->numOfVisits) mostVisited = &this->tree[s];
+                }
+                if(mostVisited->numOfVisits == 0) break;
+                entry.pv.push_back((symmetry > 0) ? untransformMove<Board>(mostVisited->action(), symmetry) : mostVisited->action());
+                current = mostVisited;
+            }
         }
+        analysis.push_back(entry);
     }
-    move.row = mostPromising->action.row;
-    move.column = mostPromising->action.column;
-#if defined(DEBUG)
-    std::cout << "Root visits: " << this->tree->numOfVisits << std::endl;
-#endif  // DEBUG
-    // Move the root to the most promising node and delete the rest
-    createScion(this->tree, mostPromising);
-    this->tree = mostPromising;
+
+    // Best first, so the first move is the one chooseMove() would play after the same iterations
+    std::stable_sort(analysis.begin(), analysis.end(), [](const MoveAnalysis& a, const MoveAnalysis& b) { return a.score > b.score; });
 #if defined(VERBOSE) || defined(DEBUG)
-    std::cout << "\tFound optimal move: " << move.row << ", " << move.column << " of value " << max << std::endl;
-#elif defined(MINIMAL_VERBOSE)
-    std::cout << game->turns << " " << this->mark << ":" << move.row << "," << move.column << std::endl;
-#endif
-    return move;
+    std::cout << "\tMonte Carlo AI analyzed " << analysis.size() << " moves from " << root.numOfVisits << " root visits" << std::endl;
+#endif  // defined(VERBOSE) || defined(DEBUG)
+    return analysis;
 }
 
-int AIPlayerMonteCarlo::getNodeResult(MonteCarloTreeNode* node) {
+template<class Board>
+AIPlayerMonteCarlo<Board>::AIPlayerMonteCarlo(AIPlayerMonteCarlo* owner): BoardPlayer<Board>(owner->code, owner->mark), random(owner->random.next()) {
+    this->owner = owner;
+    this->iterations = owner->iterations;
+    this->opponentMark = owner->opponentMark;
+}
+
+template<class Board>
+int AIPlayerMonteCarlo<Board>::getNodeResult(const Node& node) {
     int result = 0;
 
-    result = playerWins(this->mark, node->gameState) ? 1 : result;
-    result = playerWins(this->opponentMark, node->gameState) ? -1 : result;
+    int state = terminalState(node.gameState);
+    if(state == PLAYER_X_WON || state == PLAYER_O_WON) result = (state == this->code) ? WIN : LOSS;
 
     return result;
 }
 
-MonteCarloTreeNode* AIPlayerMonteCarlo::selection(MonteCarloTreeNode* root, float (*selectionFunction)(MonteCarloTreeNode*)) {
-    MonteCarloTreeNode* node = root;
+template<class Board>
+uint32_t AIPlayerMonteCarlo<Board>::selection(uint32_t root, float (*selectionFunction)(const Node&, int), int virtualLoss) {
+    uint32_t node = root;
+    if(virtualLoss != 0) this->tree[node].numOfVisits.fetch_add(virtualLoss, std::memory_order_relaxed);
 
-    while(!node->successors.empty()) {
-        // Scan successors to find which one has the greatest promise
+    int numOfSuccessors;
+    while((numOfSuccessors = this->tree[node].numOfSuccessors.load(std::memory_order_acquire)) > 0) {
+        // Scan successors to find which one has the greatest promise.  They are side by side in the tree.
+        const Node& current = this->tree[node];
+        int numOfVisits = current.numOfVisits.load(std::memory_order_relaxed);
         float max = -1;
-        MonteCarloTreeNode* mostPromising;
-        for(MonteCarloTreeNode* successor : node->successors) {
-            float value = selectionFunction(successor);
+        uint32_t mostPromising = current.successors;
+        for(uint32_t successor = current.successors; successor < current.successors + numOfSuccessors; successor++) {
+            float value = selectionFunction(this->tree[successor], numOfVisits);
             if(value > max) {
                 max = value;
                 mostPromising = successor;
             }
         }
         node = mostPromising;
+        if(virtualLoss != 0) this->tree[node].numOfVisits.fetch_add(virtualLoss, std::memory_order_relaxed);
     }
 
     return node;
 }
 
-MonteCarloTreeNode* AIPlayerMonteCarlo::expansion(MonteCarloTreeNode* leaf) {
-    MonteCarloTreeNode* newNode = leaf;
+template<class Board>
+uint32_t AIPlayerMonteCarlo<Board>::expansion(uint32_t leaf, Xoshiro256& random) {
+    uint32_t newNode = leaf;
+    // If another thread is expanding this node, or already has, do nothing.
+    if(this->tree[leaf].claimed.exchange(true, std::memory_order_acquire)) return newNode;
     // If this is a terminal node, do nothing.
-    if(!leaf->untriedActions.empty()) { // Otherwise,
-	    // Expand all untried actions
-	    bool nextPlayer = (leaf->player == SELF) ? OPPONENT : SELF;
-	    for(moveRCPair untriedAction : leaf->untriedActions) {
-    	    char nextGameState[3][3];
-	        copyGameState(leaf->gameState, nextGameState);
-	        nextGameState[untriedAction.row][untriedAction.column] = (nextPlayer == SELF) ? this->mark : this->opponentMark;
-	        newNode = createNode(nextPlayer, nextGameState, untriedAction, leaf, leaf->depth++);
-	        leaf->successors.push_back(newNode);
-	    }
-	    leaf->untriedActions.clear();
+    if(!this->tree[leaf].untriedActions.empty()) { // Otherwise,
+        // Expand all untried actions
+        bool nextPlayer = (this->tree[leaf].player == SELF) ? OPPONENT : SELF;
+        Board gameState = this->tree[leaf].gameState;
+        typename Board::MoveSet untriedActions = this->tree[leaf].untriedActions;
+        // Canonical hashes of the successors so far.  Symmetric moves share the first one's node.
+        uint64_t siblings[Board::CELLS];
+        int numOfSiblings = 0;
+        // The successors are found first, so their nodes can be added together
+        moveRCPair actions[Board::CELLS];
+        Board nextGameStates[Board::CELLS];
+        int numOfSuccessors = 0;
+        for(moveRCPair untriedAction : untriedActions) {
+            Board nextGameState = gameState;
+            nextGameState.set(untriedAction.row, untriedAction.column, (nextPlayer == SELF) ? this->mark : this->opponentMark);
+            if(this->useSymmetry) {
+                uint64_t canonical = zobristBoardHash(canonicalize(nextGameState).state);
+                if(std::find(siblings, siblings + numOfSiblings, canonical) != siblings + numOfSiblings) continue;
+                siblings[numOfSiblings++] = canonical;
+            }
+            actions[numOfSuccessors] = untriedAction;
+            nextGameStates[numOfSuccessors++] = nextGameState;
+        }
+        // The successors are side by side, so the first one's index and their number find them all
+        uint32_t first = this->tree.allocateSuccessors(numOfSuccessors);
+        for(int i = 0; i < numOfSuccessors; i++) this->tree.setNode(first + i, nextPlayer, nextGameStates[i], actions[i], leaf);
+        Node& node = this->tree[leaf];
+        node.untriedActions.clear();
+        node.successors = first;
+        // Other threads may select the successors once they see their number
+        node.numOfSuccessors.store(numOfSuccessors, std::memory_order_release);
 
         // If successors were generated, randomly pick one of the new nodes
-        srand(time(NULL));
-        std::list<MonteCarloTreeNode*>::iterator it = leaf->successors.begin();
-        int randomIndex = rand() % leaf->successors.size();
-        for(int i = 0; i < randomIndex; i++) it++;
-        newNode = *it;
+        newNode = first + random.below(numOfSuccessors);
     }
 
     return newNode;
 }
 
-int AIPlayerMonteCarlo::simulation(MonteCarloTreeNode* node, moveRCPair (*playoutFunction)(char player, char gameState[3][3])) {
+template<class Board>
+int AIPlayerMonteCarlo<Board>::simulation(uint32_t node, moveRCPair (*playoutFunction)(char player, const Board& gameState, Xoshiro256& random), Xoshiro256& random) {
     int result = 0;
     int moves = 1;
 
-    if(isTerminalNode(node)) {  // If this is a terminal node
+    if(isTerminalNode(this->tree[node])) {  // If this is a terminal node
         // Return the actual result
-        result = getNodeResult(node);
+        result = getNodeResult(this->tree[node]);
     }
     else {
-        MonteCarloTreeNode nodeCopy;
-        copyGameState(node->gameState, nodeCopy.gameState);
-       char currentPlayer = (node->player == false) ? this->mark : this->opponentMark;
-
-        while(!isTerminalNode(&nodeCopy)) {
-            moves++;
-            // Let the current player play a move
-            moveRCPair move = lightPlayout(currentPlayer, nodeCopy.gameState);  // Pick a move
-            nodeCopy.gameState[move.row][move.column] = currentPlayer;    // Mark the game state
-            // Switch players
-            currentPlayer = (currentPlayer == this->mark) ? this->opponentMark : this->mark;
-        }
-
-        result = getNodeResult(&nodeCopy);
+        result = this->playout(this->tree[node], playoutFunction, random, moves);
     }
 
     // If the result is a win, update minSimMovesToWin
-    if(result == 1) node->minSimMovesToWin = moves;
+    if(result == 1) this->tree[node].minSimMovesToWin.store(moves, std::memory_order_relaxed);
 
     return result;
 }
 
-void AIPlayerMonteCarlo::backpropagation(MonteCarloTreeNode* node, int result) {
-    MonteCarloTreeNode* temp = node;
-    int minSimMovesToWin = node->minSimMovesToWin;
+template<class Board>
+PlayoutResults AIPlayerMonteCarlo<Board>::simulateBatch(uint32_t node, moveRCPair (*playoutFunction)(char player, const Board& gameState, Xoshiro256& random),
+                                                        int playouts, Xoshiro256& random) {
+    PlayoutResults results;
+    const Node& start = this->tree[node];
+
+    if(isTerminalNode(start)) {
+        // Every playout ends at once with the actual result
+        int result = getNodeResult(start);
+        for(int i = 0; i < playouts; i++) results.add(result, 1);
+    }
+    else {
+        for(int i = 0; i < playouts; i++) {
+            int moves = 1;
+            int result = this->playout(start, playoutFunction, random, moves);
+            results.add(result, moves);
+        }
+    }
 
-    while(temp != NULL) {
-        // Update values
-        temp->numOfVisits++;
-        if(result == 0) temp->numOfDraws++;
-        else if(result == -1) temp->numOfLosses++;
-        else if(result == 1) temp->numOfWins++;
+    return results;
+}
 
-        if(result == 1 && temp->minSimMovesToWin > minSimMovesToWin) {
-            temp->minSimMovesToWin = minSimMovesToWin;
+template<class Board>
+int AIPlayerMonteCarlo<Board>::playout(const Node& node, moveRCPair (*playoutFunction)(char player, const Board& gameState, Xoshiro256& random),
+                                       Xoshiro256& random, int& moves) {
+    // Play out on one game in place.  The result of each move comes from the lines through its box.
+    Game<Board> rollout(node.gameState, (node.player == OPPONENT) ? this->code : -1 * this->code);
+    int state = ONGOING;
+
+    while(state == ONGOING) {
+        moves++;
+        // Let the current player play a move
+        moveRCPair move = playoutFunction(codeToMark(rollout.currentPlayer), rollout.board.state, random);  // Pick a move
+        state = rollout.makeMove(move.row, move.column);    // Mark the game state and switch players
+    }
+
+    if(state == DRAW) return 0;
+    return (state == this->code) ? WIN : LOSS;
+}
+
+template<class Board>
+void AIPlayerMonteCarlo<Board>::backpropagation(uint32_t node, int result, int virtualLoss) {
+    PlayoutResults results;
+    results.add(result, this->tree[node].minSimMovesToWin.load(std::memory_order_relaxed));
+    this->backpropagation(node, results, virtualLoss);
+}
+
+template<class Board>
+void AIPlayerMonteCarlo<Board>::backpropagation(uint32_t node, const PlayoutResults& results, int virtualLoss) {
+    uint32_t temp = node;
+    int visits = results.playouts() - virtualLoss;
+
+    while(temp != NO_NODE) {
+        // Update values.  The visit of selection() was counted already.
+        Node& current = this->tree[temp];
+        if(visits != 0) current.numOfVisits.fetch_add(visits, std::memory_order_relaxed);
+        if(results.draws != 0) current.numOfDraws.fetch_add(results.draws, std::memory_order_relaxed);
+        if(results.losses != 0) current.numOfLosses.fetch_add(results.losses, std::memory_order_relaxed);
+        if(results.wins != 0) {
+            current.numOfWins.fetch_add(results.wins, std::memory_order_relaxed);
+            int known = current.minSimMovesToWin.load(std::memory_order_relaxed);
+            while(known > results.minMovesToWin && !current.minSimMovesToWin.compare_exchange_weak(known, results.minMovesToWin, std::memory_order_relaxed)) {}
         }
 
         // Move to the next predecessor
-        temp = temp->predecessor;
+        temp = current.predecessor;
     }
 }
+
+#define INSTANTIATE_AIPLAYERMONTECARLO(Board) \
+    template class MonteCarloTree<Board>; \
+    template moveRCPair lightPlayout(char, const Board&, Xoshiro256&); \
+    template float ucb(const MonteCarloTreeNode<Board>&, int); \
+    template float promise(const MonteCarloTreeNode<Board>&); \
+    template bool isTerminalNode(const MonteCarloTreeNode<Board>&); \
+    template class AIPlayerMonteCarlo<Board>;
+FOR_EACH_GAME(INSTANTIATE_AIPLAYERMONTECARLO)
@@ -8,79 +8,260 @@
 #ifndef AIPLAYERMONTECARLO
 #define AIPLAYERMONTECARLO
 
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "nodearena.h"
+#include "prng.h"
 #include "player.h"
 #include "game.h"
+#include "symmetry.h"
+#include "tablebase.h"
+#include "threats.h"
 
 #define SELF true
 #define OPPONENT false
 
-struct MonteCarloTreeNode {
-    int player = -1;    // -1 by default.  Given value SELF or OPPONENT
-    char gameState[3][3] = BLANK_BOARD; // The game state.
-    moveRCPair action;  // The action that lead to this state.
+// Index of no node in a MonteCarloTree
+const uint32_t NO_NODE = UINT32_MAX;
 
-    int depth = 0;  // The depth of this node relative to the root
+// Searches of AIPlayerMonteCarlo::parallelMode, with more than one thread
+const int PARALLEL_ROOT = 0;    // Each thread grows a tree of its own, and the results of the roots' moves are added up
+const int PARALLEL_TREE = 1;    // The threads grow one tree together, with virtual loss to spread them over it
+const int PARALLEL_LEAF = 2;    // One thread grows the tree, and the playouts from each leaf are split over all of them
 
-    MonteCarloTreeNode* predecessor; // A pointer to the predecessor node.
-    std::list<MonteCarloTreeNode*> successors;  // Pointers to the successor nodes.
+/**
+ * The results of a batch of playouts from one node, backpropagated together.
+ */
+struct PlayoutResults {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+    // The fewest moves a winning playout took
+    int minMovesToWin = INT32_MAX;
 
-    std::list<moveRCPair> untriedActions;  // A list of r/c pairs of the unexplored actions.
+    // Count the @param result of a playout that took @param moves
+    void add(int result, int moves = INT32_MAX) {
+        if(result == WIN) {
+            this->wins++;
+            this->minMovesToWin = std::min(this->minMovesToWin, moves);
+        }
+        else if(result == LOSS) this->losses++;
+        else this->draws++;
+    }
 
-    int numOfVisits = 0;
-    int numOfWins = 0;
-    int numOfLosses = 0;
-    int numOfDraws = 0;
-    // The minimum number of moves for this or a descendant to simulate a win.
-    // Used to weight node that lead to quicker wins.
-    int minSimMovesToWin = INT32_MAX;
+    void add(const PlayoutResults& other) {
+        this->wins += other.wins;
+        this->draws += other.draws;
+        this->losses += other.losses;
+        this->minMovesToWin = std::min(this->minMovesToWin, other.minMovesToWin);
+    }
+
+    int playouts() const { return this->wins + this->draws + this->losses; }
 };
 
 /**
- * Create a node with the given @param player, @param gameState, @param action, @param predecessor, and @param depth.
- * The untriedActions member is created from the @param gameState.
+ * A node of the MCTS game tree, linked to the others by their indexes in the tree.
+ * The statistics of siblings are read together by every selection, so they come first.
+ * They are atomic, so threads sharing the tree update them without a lock.  Copies read each one once.
  */
-MonteCarloTreeNode* createNode(bool player, char gameState[3][3], moveRCPair action, MonteCarloTreeNode* predecessor, int depth);
+template<class Board>
+struct MonteCarloTreeNode {
+    std::atomic<int> numOfVisits{0};
+    std::atomic<int> numOfWins{0};
+    std::atomic<int> numOfDraws{0};
+    // The minimum number of moves for this or a descendant to simulate a win.
+    // Used to weight node that lead to quicker wins.
+    std::atomic<int> minSimMovesToWin{INT32_MAX};
+    std::atomic<int> numOfLosses{0};
+
+    uint32_t predecessor = NO_NODE;     // The index of the predecessor node.
+    uint32_t successors = NO_NODE;      // The index of the first successor.  The successors of a node are contiguous.
+    // Stored after the successors are made, so a thread that sees it above 0 finds them made
+    std::atomic<uint8_t> numOfSuccessors{0};
+    std::atomic<bool> claimed{false};   // Set by the one thread that expands the node
+    bool player = OPPONENT;             // SELF or OPPONENT
+    int8_t actionRow = -1;              // The action that lead to this state.
+    int8_t actionCol = -1;
+
+    typename Board::MoveSet untriedActions;  // The set of unexplored actions.
+    Board gameState; // The game state.
+
+    MonteCarloTreeNode() {}
+    MonteCarloTreeNode(const MonteCarloTreeNode& other) { *this = other; }
+
+    MonteCarloTreeNode& operator=(const MonteCarloTreeNode& other) {
+        this->numOfVisits.store(other.numOfVisits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->numOfWins.store(other.numOfWins.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->numOfDraws.store(other.numOfDraws.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->minSimMovesToWin.store(other.minSimMovesToWin.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->numOfLosses.store(other.numOfLosses.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->predecessor = other.predecessor;
+        this->successors = other.successors;
+        this->numOfSuccessors.store(other.numOfSuccessors.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->claimed.store(other.claimed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        this->player = other.player;
+        this->actionRow = other.actionRow;
+        this->actionCol = other.actionCol;
+        this->untriedActions = other.untriedActions;
+        this->gameState = other.gameState;
+        return *this;
+    }
+
+    moveRCPair action() const { return std::make_pair((int)this->actionRow, (int)this->actionCol); }
+};
 
 /**
- * Performs light playout which returns a random valid move from the given player and game state.
+ * The nodes of an MCTS game tree in a NodeArena, so a node and its successors are found without following pointers.
+ * Nodes do not move as the tree grows.
  */
-moveRCPair lightPlayout(char player, char gameState[3][3]);
+template<class Board>
+class MonteCarloTree {
+    public:
+        typedef MonteCarloTreeNode<Board> Node;
+
+        NodeArena<Node> nodes;
+        // The index of the root, or NO_NODE if the tree is empty
+        uint32_t root = NO_NODE;
+
+        Node& operator[](uint32_t index) { return this->nodes[index]; }
+        const Node& operator[](uint32_t index) const { return this->nodes[index]; }
+
+        bool empty() const { return this->root == NO_NODE; }
+
+        // Number of nodes in the tree
+        size_t size() const { return this->nodes.live(); }
+
+        // The most nodes the tree has had
+        size_t peak() const { return std::max(this->nodes.peak(), this->scion.peak()); }
+
+        // Bytes held by the nodes, including the blocks kept for scions
+        size_t memoryUsed() const { return this->nodes.memoryUsed() + this->scion.memoryUsed(); }
+
+        /**
+         * Add @param n contiguous nodes for the successors of one node, and return the index of the first.
+         * Threads sharing the tree may add nodes at once, after reserve().
+         */
+        uint32_t allocateSuccessors(int n) {
+            std::lock_guard<std::mutex> guard(this->allocation);
+            return this->nodes.allocate(n);
+        }
+
+        /**
+         * Make room for @param n more nodes, so threads can add them while others read the tree.
+         */
+        void reserve(uint64_t n) { this->nodes.reserve(n); }
+
+        /**
+         * Fill in the node at @param index with @param player, @param gameState, @param action, and @param predecessor.
+         * The untriedActions member is created from the @param gameState.
+         */
+        void setNode(uint32_t index, bool player, const Board& gameState, moveRCPair action, uint32_t predecessor);
+
+        /**
+         * Add a node with the given @param player, @param gameState, @param action, and @param predecessor, and return its index.
+         * The untriedActions member is created from the @param gameState.
+         * The first node added to an empty tree is its root.
+         */
+        uint32_t createNode(bool player, const Board& gameState, moveRCPair action, uint32_t predecessor);
+
+        /**
+         * Delete all nodes.
+         */
+        void clear();
+
+        /**
+         * @brief Delete the tree except for the node at keep and its descendents, and make it the root.
+         * The kept nodes are copied together breadth first into the scion arena, so their indexes change,
+         * and then the arenas trade places and the old nodes are released at once.
+         * 
+         * @param keep The root of the subtree to avoid deleting
+         */
+        void createScion(uint32_t keep);
+
+    private:
+        // Blocks for the next createScion() to copy into
+        NodeArena<Node> scion;
+        // Held by threads sharing the tree while they add nodes
+        std::mutex allocation;
+
+        // Copy the successors of the node at @param from, and their descendents, below its copy at @param to in the scion arena.
+        void copySuccessors(uint32_t from, uint32_t to);
+};
 
 /**
- * Return the upper confidence bound value of the given node.
+ * Performs light playout which returns a random valid move from the given player and game state, drawn from @param random.
  */
-float ucb(MonteCarloTreeNode* node);
+template<class Board>
+moveRCPair lightPlayout(char player, const Board& gameState, Xoshiro256& random);
 
 /**
- * Returns if the node corresponds to a win/loss/draw.
+ * Return the upper confidence bound value of the given node, whose predecessor has @param predNumOfVisits visits.
  */
-bool isTerminalNode(MonteCarloTreeNode* node);
+template<class Board>
+float ucb(const MonteCarloTreeNode<Board>& node, int predNumOfVisits);
 
 /**
- * Delete all nodes of the search tree with the given @param root.
+ * Return the value that a move to the given node is played by: the rate of wins and draws, with wins counting double,
+ * over the square root of the fewest moves a simulation through the node took to win.
  */
-void deleteTree(MonteCarloTreeNode* root);
+template<class Board>
+float promise(const MonteCarloTreeNode<Board>& node);
 
 /**
- * @brief Delete the tree from the given root except for the node at keep and its descendents.
- * 
- * @param root The root of the game tree
- * @param keep The root of the subtree to avoid deleting
+ * Returns if the node corresponds to a win/loss/draw.
  */
-void createScion(MonteCarloTreeNode* root, MonteCarloTreeNode* keep);
+template<class Board>
+bool isTerminalNode(const MonteCarloTreeNode<Board>& node);
 
-class AIPlayerMonteCarlo: public Player {
+template<class Board>
+class AIPlayerMonteCarlo: public BoardPlayer<Board> {
     public:
+        typedef MonteCarloTreeNode<Board> Node;
+
         // The number of iterations to run MCTS.
         int iterations = 0;
 
-        // Game tree root
-        MonteCarloTreeNode* tree = NULL;
+        // Game tree
+        MonteCarloTree<Board> tree;
 
         // The opponent's mark
         char opponentMark;
 
-        AIPlayerMonteCarlo(int code, int mark, int iterations): Player(code, mark) {
+        // Share one node among moves to symmetric states, and follow the game into symmetric states of the tree
+        bool useSymmetry = true;
+
+        // If set, moves of the 3x3 game are looked up here instead of searched
+        const Tablebase* tablebase = NULL;
+
+        // Play wins, blocks, and forks found by forcedMove() without searching
+        bool useThreats = true;
+
+        // Random choices of expansion and playouts.  Seeded from the clock unless seeded again.
+        Xoshiro256 random;
+
+        // Threads that search at once, as parallelMode says.  1 searches on this thread only.
+        int threads = 1;
+
+        // PARALLEL_ search of more threads.  With PARALLEL_ROOT, each thread runs the iterations on a tree of its own,
+        // and the visits and results of the roots' moves are added up to choose one.
+        // With PARALLEL_TREE, each thread runs the iterations on one shared tree.  Each statistic is updated atomically, and one thread expands each node.
+        // With PARALLEL_LEAF, this thread runs the iterations, and the other threads play out from each leaf with it.
+        int parallelMode = PARALLEL_ROOT;
+
+        // Playouts from each leaf an iteration selects, backpropagated together, so the walks of selection and backpropagation
+        // are shared by all of them.  Each counts as a visit.
+        int leafPlayouts = 1;
+
+        // Visits added to each node on the path of a selection of a shared tree, until its result is backpropagated.
+        // They count as losses for now, so other threads choose other paths.
+        int virtualLoss = 1;
+
+        AIPlayerMonteCarlo(int code, int mark, int iterations): BoardPlayer<Board>(code, mark) {
             this->iterations = iterations;
             this->opponentMark = (this->mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK;
 
@@ -91,33 +272,68 @@ class AIPlayerMonteCarlo: public Player {
         }
 
         ~AIPlayerMonteCarlo() {
-            deleteTree(tree);
+            for(AIPlayerMonteCarlo* helper : this->helpers) delete helper;
+            this->helpers.clear();
         }
 
         /**
          * Creates a game tree and uses Monte Carlo Tree Search (offline) to pick the best move.
          */
-        virtual moveRCPair chooseMove(Game* game);
+        virtual moveRCPair chooseMove(Game<Board>* game);
+
+        /**
+         * Run iterations of MCTS on the tree, and score every move of @param game by promise(), without moving the root.
+         * The principal variation of a move follows the most visited nodes below it.
+         * A later chooseMove() of the same position keeps the tree and searches on.
+         */
+        std::vector<MoveAnalysis> analyze(Game<Board>* game);
+
+        /**
+         * Move the root of the tree to the state of @param game, creating it if needed, and run iterations of MCTS from it.
+         * With threads above 1, the other threads search too, as parallelMode says.
+         * Returns the symmetry that maps the game onto the root's state, or 0 or -1 if it is the same state without useSymmetry.
+         */
+        int search(Game<Board>* game);
+
+        /**
+         * Returns a copy of the root's successor at @param successor, with the visits and results of the same move
+         * in the trees of the other threads added in.
+         */
+        Node mergedSuccessor(uint32_t successor);
+
+        // Number of players growing the trees of the other threads of a PARALLEL_ROOT search
+        int numOfHelpers() const { return (int)this->helpers.size(); }
+
+        // The tree of the helper at @param helper
+        const MonteCarloTree<Board>& helperTree(int helper) const { return this->helpers[helper]->tree; }
 
         /**
          * Returns -1/0/1 if the given grid corresponds to a loss/draw/win.
          * isTerminalNode() must be used before this.
          */
-        int getNodeResult(MonteCarloTreeNode* node);
+        int getNodeResult(const Node& node);
 
         /**
-         * From the @param root node, traverse down the tree to find a leaf node with no successors.
+         * From the @param root node, traverse down the tree to find a leaf node with no successors, and return its index.
          * Does not care if the found node is a terminal node (win/draw/loss).
-         * The selection function could be ucb(), to rate each child node.
+         * The selection function could be ucb(), to rate each child node by it and its predecessor's visits.
+         * @param virtualLoss visits are added to each node on the way, including the leaf.
          */
-        MonteCarloTreeNode* selection(MonteCarloTreeNode* root, float (*selectionFunction)(MonteCarloTreeNode*));
+        uint32_t selection(uint32_t root, float (*selectionFunction)(const Node&, int), int virtualLoss = 0);
 
         /**
          * Fully expands the given leaf node if possible.
-         * Returns a random child node if at least one was created.
+         * With useSymmetry, moves to states symmetric to an earlier successor's are left out.
+         * Returns the index of a random child node if at least one was created.
          * If expansion wasn't possible (terminal node), return the given leaf node.
          */
-        MonteCarloTreeNode* expansion(MonteCarloTreeNode* leaf);
+        uint32_t expansion(uint32_t leaf) { return this->expansion(leaf, this->random); }
+
+        /**
+         * expansion() with the random choices of @param random.
+         * Only the thread that claims the leaf expands it.  The others get the leaf back, to simulate from it.
+         */
+        uint32_t expansion(uint32_t leaf, Xoshiro256& random);
 
         /**
          * Performs simulation/playout/rollout from the given node.
@@ -125,12 +341,84 @@ class AIPlayerMonteCarlo: public Player {
          * Returns an int representing the result.
          * Returns the result if the given node is a terminal node.
          */
-        int simulation(MonteCarloTreeNode* node, moveRCPair (*playoutFunction)(char player, char gameState[3][3]));
+        int simulation(uint32_t node, moveRCPair (*playoutFunction)(char player, const Board& gameState, Xoshiro256& random)) {
+            return this->simulation(node, playoutFunction, this->random);
+        }
+
+        // simulation() with the random choices of @param random.
+        int simulation(uint32_t node, moveRCPair (*playoutFunction)(char player, const Board& gameState, Xoshiro256& random), Xoshiro256& random);
+
+        /**
+         * Performs @param playouts playouts from the given node, with the random choices of @param random, and returns their results.
+         * Unlike simulation(), the node is not changed, so threads may play out from one node at once.
+         */
+        PlayoutResults simulateBatch(uint32_t node, moveRCPair (*playoutFunction)(char player, const Board& gameState, Xoshiro256& random),
+                                     int playouts, Xoshiro256& random);
 
         /**
          * Updates all preceding nodes to the root with the given result from simulation().
+         * Takes back the @param virtualLoss visits of selection(), so each node counts one visit.
+         */
+        void backpropagation(uint32_t node, int result, int virtualLoss = 0);
+
+        /**
+         * Updates all preceding nodes to the root with the results of simulateBatch() in one pass.  Each playout counts as a visit.
          */
-        void backpropagation(MonteCarloTreeNode* node, int result);
+        void backpropagation(uint32_t node, const PlayoutResults& results, int virtualLoss = 0);
+
+    private:
+        // The player whose move this helper searches for, or NULL if this is not a helper
+        AIPlayerMonteCarlo* owner = NULL;
+        // Players growing the trees of the other threads, kept so their trees carry over from move to move
+        std::vector<AIPlayerMonteCarlo*> helpers;
+
+        // Constructor of a helper of @param owner, with a random sequence of its own
+        AIPlayerMonteCarlo(AIPlayerMonteCarlo* owner);
+
+        // search() on this tree only
+        int searchTree(Game<Board>* game);
+
+        // Move the root of the tree to the state of @param game, creating it if needed.  Returns the symmetry of search().
+        int moveRoot(Game<Board>* game);
+
+        /**
+         * The leaf played out by the threads of a PARALLEL_LEAF search, and the results they have played so far.
+         */
+        struct LeafBatch {
+            std::mutex lock;
+            std::condition_variable started;    // A new leaf is ready, or the search is over
+            std::condition_variable finished;   // Every other thread has played its share
+            uint32_t leaf = NO_NODE;
+            int leaves = 0;         // Leaves played out so far, so a thread knows a new one from the last
+            int pending = 0;        // Other threads yet to play their share of the leaf
+            bool stop = false;
+            PlayoutResults results;
+        };
+
+        // Run @param iterations of MCTS from the root with @param random, adding @param virtualLoss on each path.
+        // With @param batch, the other threads play out from each leaf too.
+        void iterate(int iterations, Xoshiro256& random, int virtualLoss, LeafBatch* batch = NULL);
+
+        // Play out one game from @param node, which is not terminal, adding its moves to @param moves.  Returns the result.
+        int playout(const Node& node, moveRCPair (*playoutFunction)(char player, const Board& gameState, Xoshiro256& random),
+                    Xoshiro256& random, int& moves);
+
+        // Play the playouts from each leaf of @param batch by thread @param thread, until it stops
+        void playLeaves(LeafBatch& batch, int thread, Xoshiro256& random);
+
+        // Playouts of the leafPlayouts from each leaf played by @param thread of the threads
+        int shareOfPlayouts(int thread) const {
+            return this->leafPlayouts * (thread + 1) / this->threads - this->leafPlayouts * thread / this->threads;
+        }
+
+        /**
+         * Returns the index of the root's successor with @param state, or a state symmetric to it with useSymmetry, or NO_NODE.
+         * @param symmetry is set to the symmetry that maps @param state onto the successor's.
+         */
+        uint32_t findSuccessor(const Board& state, int& symmetry);
+
+        // Delete this tree and the helpers' trees, when the game moves on without them
+        void clearTrees();
 };
 
 #endif  // AIPLAYERMONTECARLO
\ No newline at end of file
@@ -0,0 +1,152 @@
+/**
+ *  @file playerproofnumber.cpp
+ *  @author Vincent Li
+ */
+
+#include "playerproofnumber.h"
+
+#if defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
+#include <iostream>
+#endif  // defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
+
+template<class Board>
+moveRCPair AIPlayerProofNumber<Board>::chooseMove(Game<Board>* game) {
+    Game<Board> position(game->board.state, this->code);
+    this->nodesExpanded = 0;
+    this->memoryUsed = 0;
+    int opponent = (this->code == PLAYER_X_CODE) ? PLAYER_O_CODE : PLAYER_X_CODE;
+
+    // Can this player win?
+    bool solved = search(position, this->code);
+    const Node* children = &this->tree[this->tree[0].firstChild];
+    int numOfChildren = this->tree[0].numOfChildren;
+    int best = 0;
+    if(solved && this->tree[0].proof == 0) {
+        // Any proved child wins
+        this->proven = PROVEN_WIN;
+        while(children[best].proof != 0) best++;
+    }
+    else if(!solved) {
+        // Closest to a win
+        this->proven = PROVEN_UNKNOWN;
+        for(int i = 1; i < numOfChildren; i++) if(children[i].proof < children[best].proof) best = i;
+    }
+    else {
+        // If not, can the opponent?  At the root, the opponent needs a win against every move.
+        solved = search(position, opponent);
+        children = &this->tree[this->tree[0].firstChild];
+        if(solved && this->tree[0].disproof == 0) {
+            // A disproved child holds the draw
+            this->proven = PROVEN_DRAW;
+            while(children[best].disproof != 0) best++;
+        }
+        else if(solved) this->proven = PROVEN_LOSS;
+        else {
+            // Closest to a draw
+            this->proven = PROVEN_UNKNOWN;
+            for(int i = 1; i < numOfChildren; i++) if(children[i].disproof < children[best].disproof) best = i;
+        }
+    }
+    moveRCPair move = std::make_pair((int)children[best].row, (int)children[best].col);
+
+#if defined(VERBOSE) || defined(DEBUG)
+    const char* names[] = {"lost", "drawn", "won", "unknown"};
+    std::cout << "\tProof-number AI expanded " << this->nodesExpanded << " nodes in " << this->memoryUsed / 1024 << " KB" << std::endl;
+    std::cout << "\tFound " << ((this->proven == PROVEN_UNKNOWN) ? "most promising" : "proven") << " move: " << move.row << ", " << move.column
+                << ((this->proven == PROVEN_UNKNOWN) ? " of an " : " of a ") << names[this->proven + 1] << " position" << std::endl;
+#elif defined(MINIMAL_VERBOSE)
+    std::cout << game->turns << " " << this->mark << ":" << move.row << "," << move.column << std::endl;
+#endif
+
+    // Free the tree between moves
+    std::vector<Node>().swap(this->tree);
+    return move;
+}
+
+template<class Board>
+bool AIPlayerProofNumber<Board>::search(Game<Board>& game, int attacker) {
+    this->tree.clear();
+    this->tree.push_back(Node());
+    // Indexes of the nodes from the root to the one being expanded
+    std::vector<int> path;
+
+    while(this->tree[0].proof != 0 && this->tree[0].disproof != 0 && (long)this->tree.size() < this->nodeLimit) {
+        // Select the most-proving node: the cheapest child to prove where the attacker moves, and to disprove where the defender does
+        int index = 0;
+        path.clear();
+        while(this->tree[index].expanded) {
+            path.push_back(index);
+            const Node& node = this->tree[index];
+            bool attackerToMove = (game.currentPlayer == attacker);
+            int best = node.firstChild;
+            for(int i = node.firstChild + 1; i < (int)(node.firstChild + node.numOfChildren); i++) {
+                if(attackerToMove ? this->tree[i].proof < this->tree[best].proof : this->tree[i].disproof < this->tree[best].disproof) best = i;
+            }
+            game.makeMove(this->tree[best].row, this->tree[best].col);
+            index = best;
+        }
+
+        expand(game, index, attacker);
+        update(index, game.currentPlayer == attacker);
+
+        // Back up the numbers to the root, taking the moves back
+        for(int i = (int)path.size() - 1; i >= 0; i--) {
+            game.undoMove();
+            update(path[i], game.currentPlayer == attacker);
+        }
+    }
+
+    this->nodesExpanded += (long)this->tree.size() - 1;
+    size_t bytes = this->tree.capacity() * sizeof(Node);
+    if(bytes > this->memoryUsed) this->memoryUsed = bytes;
+    return this->tree[0].proof == 0 || this->tree[0].disproof == 0;
+}
+
+template<class Board>
+void AIPlayerProofNumber<Board>::expand(Game<Board>& game, int index, int attacker) {
+    typename Board::MoveSet validActions = getValidActions(game.board.state);
+    uint32_t first = (uint32_t)this->tree.size();
+    for(moveRCPair move : validActions) {
+        Node child;
+        child.row = move.row;
+        child.col = move.column;
+        int result = game.makeMove(move.row, move.column);
+        if(result == attacker) {
+            child.proof = 0;
+            child.disproof = PN_INFINITY;
+        }
+        else if(result != ONGOING) {
+            // The defender won, or it is a draw
+            child.proof = PN_INFINITY;
+            child.disproof = 0;
+        }
+        game.undoMove();
+        this->tree.push_back(child);
+    }
+
+    // References into the tree are only taken after it grows
+    Node& node = this->tree[index];
+    node.firstChild = first;
+    node.numOfChildren = (uint8_t)validActions.size();
+    node.expanded = true;
+}
+
+template<class Board>
+void AIPlayerProofNumber<Board>::update(int index, bool attackerToMove) {
+    Node& node = this->tree[index];
+    uint32_t minimum = PN_INFINITY;
+    uint32_t sum = 0;
+    for(int i = node.firstChild; i < (int)(node.firstChild + node.numOfChildren); i++) {
+        const Node& child = this->tree[i];
+        // The attacker needs one child proved and all disproved to fail.  The defender is the other way around.
+        uint32_t one = attackerToMove ? child.proof : child.disproof;
+        uint32_t all = attackerToMove ? child.disproof : child.proof;
+        if(one < minimum) minimum = one;
+        sum = (sum + all >= PN_INFINITY) ? PN_INFINITY : sum + all;
+    }
+    node.proof = attackerToMove ? minimum : sum;
+    node.disproof = attackerToMove ? sum : minimum;
+}
+
+#define INSTANTIATE_AIPLAYERPROOFNUMBER(Board) template class AIPlayerProofNumber<Board>;
+FOR_EACH_GAME(INSTANTIATE_AIPLAYERPROOFNUMBER)
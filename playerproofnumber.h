@@ -0,0 +1,95 @@
+/**
+ *  @file playerproofnumber.h
+ *  @author Vincent Li
+ *  Implements an AI player that solves the game with proof-number search.
+ *  Instead of searching to a depth, the search expands the leaf that is cheapest to prove or disprove the root with,
+ *  so it goes deep where the opponent has few replies, like forced wins.
+ */
+
+#pragma once
+#ifndef AIPLAYERPROOFNUMBER
+#define AIPLAYERPROOFNUMBER
+
+#include <stdint.h>
+#include <vector>
+
+#include "player.h"
+
+// Proof or disproof number of a node that can not be proved or disproved
+const uint32_t PN_INFINITY = 1u << 30;
+
+// What the last search proved the position to be, for the player to move
+const int PROVEN_UNKNOWN = 2;   // The node limit was reached first
+const int PROVEN_WIN = WIN;
+const int PROVEN_LOSS = LOSS;
+const int PROVEN_DRAW = DRAW;
+
+// A node of the proof-number search tree.  Children are stored together, so a node only keeps the index of the first.
+struct ProofNumberNode {
+    uint32_t proof = 1;     // Leaves to prove to show the attacker wins
+    uint32_t disproof = 1;  // Leaves to disprove to show the attacker does not
+    uint32_t firstChild = 0;
+    uint8_t numOfChildren = 0;
+    int8_t row = -1;        // The move to this node
+    int8_t col = -1;
+    bool expanded = false;
+};
+
+template<class Board>
+class AIPlayerProofNumber: public BoardPlayer<Board> {
+    public:
+        typedef ProofNumberNode Node;
+
+        // Most nodes in a search tree.  A search that reaches it gives up and plays its most promising move.
+        long nodeLimit = 1 << 22;
+        // Nodes expanded by the searches of the last move
+        long nodesExpanded = 0;
+        // Bytes of the largest tree of the last move
+        size_t memoryUsed = 0;
+        // PROVEN_ value of the last move's position
+        int proven = PROVEN_UNKNOWN;
+
+        // Constructor
+        AIPlayerProofNumber(int code, char mark, long nodeLimit = 1 << 22): BoardPlayer<Board>(code, mark) {
+            this->nodeLimit = (nodeLimit <= 0) ? (1 << 22) : nodeLimit;
+
+            // Introduction
+#if defined(VERBOSE)
+            std::cout << "Introducing Player " << this->mark << ", who is a proof-number search AI of up to " << this->nodeLimit << " nodes" << std::endl;
+#endif  // VERBOSE
+        }
+
+        ~AIPlayerProofNumber() {}
+
+        /**
+         *  Prove whether this player can win, and if not, whether the opponent can, and play the proven move.
+         *  A won position plays a winning move, a drawn one a move the opponent can not win against, and a lost one any move.
+         *  If a search reaches nodeLimit, plays the move closest to proving its question.
+         */
+        moveRCPair chooseMove(Game<Board>* game);
+
+        /**
+         *  Perform proof-number search on whether the player with code @param attacker can force a win from @param game,
+         *  with the player to move at the root.  Draws count as not winning.
+         *  Moves are made and taken back on @param game.  The tree is left in tree, with its root at index 0.
+         *  Returns true if the root was proved or disproved before nodeLimit.
+         */
+        bool search(Game<Board>& game, int attacker);
+
+        // The search tree.  Children of a node are contiguous.
+        std::vector<Node> tree;
+
+    private:
+        /**
+         *  Add the children of @param index for each move of @param game, and set their numbers from the result of the move.
+         */
+        void expand(Game<Board>& game, int index, int attacker);
+
+        /**
+         *  Set the proof and disproof numbers of @param index from its children.
+         *  @param attackerToMove is true if it is an OR node, where the attacker picks the move.
+         */
+        void update(int index, bool attackerToMove);
+};
+
+#endif  // AIPLAYERPROOFNUMBER
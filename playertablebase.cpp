@@ -0,0 +1,25 @@
+/**
+ *  @file playertablebase.cpp
+ *  @author Vincent Li
+ */
+
+#include "playertablebase.h"
+
+#if defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
+#include <iostream>
+#endif  // defined(MINIMAL_VERBOSE) || defined(VERBOSE) || defined(DEBUG)
+
+moveRCPair AIPlayerTablebase::chooseMove(Game<TicTacToe>* game) {
+    const TablebaseEntry* entry = this->tablebase.lookup(game->board.state, this->code);
+    // Every position reachable in a game is in the tablebase, so this only happens without a file
+    if(entry == NULL || entry->bestMoves == 0) return getValidActions(game->board.state).nth(0);
+
+    moveRCPair move = Tablebase::pickMove(entry);
+#if defined(VERBOSE) || defined(DEBUG)
+    std::cout << "\tFound optimal move: " << move.row << ", " << move.column << " of value " << (int)entry->value
+                << " in " << (int)entry->distance << " moves" << std::endl;
+#elif defined(MINIMAL_VERBOSE)
+    std::cout << game->turns << " " << this->mark << ":" << move.row << "," << move.column << std::endl;
+#endif
+    return move;
+}
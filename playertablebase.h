@@ -0,0 +1,42 @@
+/**
+ *  @file playertablebase.h
+ *  @author Vincent Li
+ *  Implements an AI player of the 3x3 game that looks up perfect moves in a tablebase file.
+ */
+
+#pragma once
+#ifndef AIPLAYERTABLEBASE
+#define AIPLAYERTABLEBASE
+
+#include <string>
+
+#include "player.h"
+#include "tablebase.h"
+
+class AIPlayerTablebase: public BoardPlayer<TicTacToe> {
+    public:
+        // The mapped tablebase file
+        Tablebase tablebase;
+
+        /**
+         *  Constructor
+         *  Maps the tablebase file at @param path.  Check tablebase.isOpen() before playing.
+         */
+        AIPlayerTablebase(int code, char mark, const std::string& path): BoardPlayer<TicTacToe>(code, mark) {
+            tablebase.open(path);
+
+            // Introduction
+#if defined(VERBOSE)
+            std::cout << "Introducing Player " << this->mark << ", who is a tablebase AI of perfect play" << std::endl;
+#endif  // VERBOSE
+        }
+
+        ~AIPlayerTablebase() {}
+
+        /**
+         *  Look up the game in the tablebase and return one of its best moves.
+         */
+        moveRCPair chooseMove(Game<TicTacToe>* game);
+};
+
+#endif  // AIPLAYERTABLEBASE
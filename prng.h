@@ -0,0 +1,80 @@
+/**
+ *  @file prng.h
+ *  @author Vincent Li
+ *  A small, fast pseudorandom number generator for the random choices of the AI players.
+ *  Each player keeps its own generator, and each thread its own, so there is no shared state to lock,
+ *  and a player given a seed makes the same choices every run.
+ */
+
+#pragma once
+#ifndef PRNG
+#define PRNG
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+/**
+ *  Returns the next number of the SplitMix64 generator and advances its state.
+ */
+constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ *  Returns a seed that differs from run to run, for generators not given one.
+ *  Threads that seed their generators at the same time still get different seeds from the count of calls.
+ */
+inline uint64_t clockSeed() {
+    static std::atomic<uint64_t> calls{0};
+    uint64_t state = std::chrono::high_resolution_clock::now().time_since_epoch().count() + calls.fetch_add(1, std::memory_order_relaxed);
+    return splitMix64(state);
+}
+
+/**
+ *  The xoshiro256** generator: 256 bits of state, a period of 2^256 - 1, and a few shifts, rotates, and XORs per number.
+ */
+class Xoshiro256 {
+    public:
+        Xoshiro256() { this->seed(clockSeed()); }
+        explicit Xoshiro256(uint64_t seed) { this->seed(seed); }
+
+        /**
+         * Restart the sequence from @param seed.  The state is filled by SplitMix64, so any seed, even 0, is fine.
+         */
+        void seed(uint64_t seed) {
+            for(int i = 0; i < 4; i++) this->state[i] = splitMix64(seed);
+        }
+
+        /**
+         * Returns the next 64 random bits.
+         */
+        uint64_t next() {
+            uint64_t result = rotate(this->state[1] * 5, 7) * 9;
+            uint64_t t = this->state[1] << 17;
+            this->state[2] ^= this->state[0];
+            this->state[3] ^= this->state[1];
+            this->state[1] ^= this->state[2];
+            this->state[0] ^= this->state[3];
+            this->state[2] ^= t;
+            this->state[3] = rotate(this->state[3], 45);
+            return result;
+        }
+
+        /**
+         * Returns a number from 0 to @param n - 1, by multiplying instead of a division.
+         */
+        uint32_t below(uint32_t n) {
+            return (uint32_t)(((this->next() >> 32) * n) >> 32);
+        }
+
+    private:
+        uint64_t state[4];
+
+        static uint64_t rotate(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+#endif  // PRNG
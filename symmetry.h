@@ -0,0 +1,159 @@
+/**
+ *  @file symmetry.h
+ *  @author Vincent Li
+ *  Rotations and reflections of game states.
+ *  Square boards have 8 symmetries and other boards have 4, and positions that are symmetric have the same value.
+ *  Symmetry t flips the rows if bit 0 is set and the columns if bit 1 is set, after transposing the board if bit 2 is set.
+ *  The canonical form of a state is the symmetric state with the smallest Zobrist hash, so caches can share one entry.
+ */
+
+#pragma once
+#ifndef SYMMETRY
+#define SYMMETRY
+
+#include <stdint.h>
+#include <array>
+
+#include "util.h"
+#include "board.h"
+#include "zobrist.h"
+
+/**
+ *  Returns the row and col that the box in the given row and col moves to under symmetry t of a rows x cols board.
+ */
+constexpr moveRCPair symmetricMove(int rows, int cols, int t, moveRCPair move) {
+    int r = (t & 4) ? move.column : move.row;
+    int c = (t & 4) ? move.row : move.column;
+    if(t & 1) r = rows - 1 - r;
+    if(t & 2) c = cols - 1 - c;
+    return std::make_pair(r, c);
+}
+
+/**
+ *  Where each box goes under each symmetry of a board, and the symmetry that undoes each one.
+ */
+template<class Board>
+struct SymmetryTable {
+    // Bit index that the box with each bit index moves to under each symmetry.
+    std::array<std::array<uint8_t, Board::CELLS>, Board::SYMMETRIES> cells;
+    // The symmetry that maps each symmetry's states back.
+    std::array<uint8_t, Board::SYMMETRIES> inverse;
+};
+
+/**
+ *  Build the SymmetryTable of the board at compile time.
+ */
+template<class Board>
+constexpr SymmetryTable<Board> createSymmetryTable() {
+    SymmetryTable<Board> table = {};
+
+    for(int t = 0; t < Board::SYMMETRIES; t++) {
+        for(int cell = 0; cell < Board::CELLS; cell++) {
+            table.cells[t][cell] = Board::toCell(symmetricMove(Board::ROWS, Board::COLS, t, Board::toMove(cell)).row,
+                                                 symmetricMove(Board::ROWS, Board::COLS, t, Board::toMove(cell)).column);
+        }
+    }
+
+    for(int t = 0; t < Board::SYMMETRIES; t++) {
+        for(int u = 0; u < Board::SYMMETRIES; u++) {
+            bool undoes = true;
+            for(int cell = 0; cell < Board::CELLS; cell++) undoes = undoes && table.cells[u][table.cells[t][cell]] == cell;
+            if(undoes) table.inverse[t] = u;
+        }
+    }
+
+    return table;
+}
+
+template<class Board>
+inline constexpr SymmetryTable<Board> SYMMETRY_TABLE = createSymmetryTable<Board>();
+
+/**
+ *  Returns the move that the given move becomes under symmetry t.
+ */
+template<class Board>
+inline moveRCPair transformMove(moveRCPair move, int t) {
+    return Board::toMove(SYMMETRY_TABLE<Board>.cells[t][Board::toCell(move.row, move.column)]);
+}
+
+/**
+ *  Returns the move that becomes the given move under symmetry t, which maps moves on a transformed board back.
+ */
+template<class Board>
+inline moveRCPair untransformMove(moveRCPair move, int t) {
+    return transformMove<Board>(move, SYMMETRY_TABLE<Board>.inverse[t]);
+}
+
+/**
+ *  Returns the mask of the boxes that the given boxes move to under symmetry t.
+ */
+template<class Board>
+inline typename Board::Mask transformMask(typename Board::Mask mask, int t) {
+    typename Board::Mask image = 0;
+    for(; mask != 0; mask &= mask - 1) image |= typename Board::Mask(1) << SYMMETRY_TABLE<Board>.cells[t][lowestBit(mask)];
+    return image;
+}
+
+/**
+ *  Returns the game state under symmetry t.
+ */
+template<int R, int C, int K>
+inline BitBoard<R, C, K> transformBoard(const BitBoard<R, C, K>& board, int t) {
+    BitBoard<R, C, K> image;
+    image.x = transformMask<BitBoard<R, C, K>>(board.x, t);
+    image.o = transformMask<BitBoard<R, C, K>>(board.o, t);
+    return image;
+}
+
+/**
+ *  Returns the symmetry that maps @param from onto @param to, or -1 if they are not symmetric.
+ */
+template<class Board>
+int symmetryBetween(const Board& from, const Board& to) {
+    if(countBits(from.x) != countBits(to.x) || countBits(from.o) != countBits(to.o)) return -1;
+
+    for(int t = 0; t < Board::SYMMETRIES; t++) {
+        if(transformBoard(from, t) == to) return t;
+    }
+    return -1;
+}
+
+/**
+ *  Returns the symmetry that maps the game state onto its canonical form.
+ *  Of the symmetries giving the same smallest hash, the first is picked.
+ */
+template<class Board>
+int canonicalSymmetry(const Board& board) {
+    int canonical = 0;
+    uint64_t smallest = zobristBoardHash(board);
+
+    for(int t = 1; t < Board::SYMMETRIES; t++) {
+        uint64_t hash = zobristBoardHash(transformBoard(board, t));
+        if(hash < smallest) {
+            smallest = hash;
+            canonical = t;
+        }
+    }
+    return canonical;
+}
+
+/**
+ *  The canonical form of a game state and the symmetry that maps the state onto it.
+ *  Moves found on the canonical state map back with untransformMove().
+ */
+template<class Board>
+struct Canonical {
+    Board state;
+    int symmetry;
+};
+
+/**
+ *  Returns the canonical form of the game state.
+ */
+template<class Board>
+Canonical<Board> canonicalize(const Board& board) {
+    int t = canonicalSymmetry(board);
+    return Canonical<Board>{transformBoard(board, t), t};
+}
+
+#endif  // SYMMETRY
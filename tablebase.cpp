@@ -0,0 +1,163 @@
+/**
+ *  @file tablebase.cpp
+ *  @author Vincent Li
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fstream>
+
+#include "tablebase.h"
+#include "player.h"
+
+/**
+ *  Returns whether a move to a position with the given value and distance is better than one to the best so far.
+ *  Values are for the player to move there.  Wins should be quick and losses slow.
+ */
+static bool isBetter(int value, int distance, int bestValue, int bestDistance) {
+    if(value != bestValue) return value > bestValue;
+    if(value == WIN) return distance < bestDistance;
+    if(value == LOSS) return distance > bestDistance;
+    return false;
+}
+
+std::vector<TablebaseEntry> createTablebase() {
+    std::vector<TablebaseEntry> entries(TABLEBASE_ENTRIES);
+
+    // Reachable positions by number of marks, with the code of the player to move
+    std::vector<std::pair<TicTacToe, int>> byMarks[TicTacToe::CELLS + 1];
+    std::vector<bool> reached(TABLEBASE_ENTRIES, false);
+
+    // Either player may move first
+    for(int first : {PLAYER_X_CODE, PLAYER_O_CODE}) {
+        reached[tablebaseIndex(TicTacToe(), first)] = true;
+        byMarks[0].push_back(std::make_pair(TicTacToe(), first));
+    }
+    for(int marks = 0; marks < TicTacToe::CELLS; marks++) {
+        for(const std::pair<TicTacToe, int>& position : byMarks[marks]) {
+            if(terminalState(position.first) != ONGOING) continue;
+
+            for(moveRCPair move : getValidActions(position.first)) {
+                TicTacToe next = position.first;
+                next.set(move.row, move.column, codeToMark(position.second));
+                int index = tablebaseIndex(next, -1 * position.second);
+                if(!reached[index]) {
+                    reached[index] = true;
+                    byMarks[marks + 1].push_back(std::make_pair(next, -1 * position.second));
+                }
+            }
+        }
+    }
+
+    // Every move adds a mark, so the positions after a move are solved before it
+    for(int marks = TicTacToe::CELLS; marks >= 0; marks--) {
+        for(const std::pair<TicTacToe, int>& position : byMarks[marks]) {
+            TablebaseEntry& entry = entries[tablebaseIndex(position.first, position.second)];
+            int result = terminalState(position.first);
+            if(result != ONGOING) {
+                // The player who just moved won, or the board is full
+                entry.value = (result == DRAW) ? DRAW : LOSS;
+                entry.distance = 0;
+                continue;
+            }
+
+            int bestValue = LOSS - 1;
+            int bestDistance = 0;
+            for(moveRCPair move : getValidActions(position.first)) {
+                TicTacToe next = position.first;
+                next.set(move.row, move.column, codeToMark(position.second));
+                const TablebaseEntry& reply = entries[tablebaseIndex(next, -1 * position.second)];
+
+                int value = -1 * reply.value;
+                int distance = reply.distance + 1;
+                uint16_t bit = 1 << TicTacToe::toCell(move.row, move.column);
+                if(isBetter(value, distance, bestValue, bestDistance)) {
+                    bestValue = value;
+                    bestDistance = distance;
+                    entry.bestMoves = bit;
+                }
+                else if(value == bestValue && distance == bestDistance) {
+                    entry.bestMoves |= bit;
+                }
+            }
+            entry.value = bestValue;
+            entry.distance = bestDistance;
+        }
+    }
+
+    return entries;
+}
+
+bool writeTablebase(const std::string& path, const std::vector<TablebaseEntry>& entries) {
+    TablebaseHeader header;
+    memcpy(header.magic, TABLEBASE_MAGIC, sizeof(header.magic));
+    header.version = TABLEBASE_VERSION;
+    header.entries = TABLEBASE_ENTRIES;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)entries.data(), entries.size() * sizeof(TablebaseEntry));
+
+    return file.good();
+}
+
+Tablebase::~Tablebase() {
+    close();
+}
+
+bool Tablebase::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat info;
+    size_t size = sizeof(TablebaseHeader) + TABLEBASE_ENTRIES * sizeof(TablebaseEntry);
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size != size) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the file is closed
+    ::close(fd);
+    if(mapped == MAP_FAILED) return false;
+
+    const TablebaseHeader* header = (const TablebaseHeader*)mapped;
+    if(memcmp(header->magic, TABLEBASE_MAGIC, sizeof(header->magic)) != 0
+            || header->version != TABLEBASE_VERSION || header->entries != TABLEBASE_ENTRIES) {
+        munmap(mapped, size);
+        return false;
+    }
+
+    mapping = mapped;
+    mappingSize = size;
+    entries = (const TablebaseEntry*)((const char*)mapped + sizeof(TablebaseHeader));
+
+    return true;
+}
+
+void Tablebase::close() {
+    if(mapping != NULL) munmap(mapping, mappingSize);
+    mapping = NULL;
+    mappingSize = 0;
+    entries = NULL;
+}
+
+const TablebaseEntry* Tablebase::lookup(const TicTacToe& board, int currentPlayer) const {
+    if(entries == NULL) return NULL;
+
+    const TablebaseEntry* entry = &entries[tablebaseIndex(board, currentPlayer)];
+    return (entry->distance == UNREACHABLE) ? NULL : entry;
+}
+
+moveRCPair Tablebase::pickMove(const TablebaseEntry* entry) {
+    MaskMoveSet<TicTacToe> moves;
+    moves.cells = entry->bestMoves;
+
+    return moves.nth(rand() % moves.size());
+}
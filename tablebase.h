@@ -0,0 +1,102 @@
+/**
+ *  @file tablebase.h
+ *  @author Vincent Li
+ *  A perfect-play tablebase of the 3x3 game, solved by retrograde analysis and memory-mapped from a file.
+ *  Entries are indexed by the player to move and the base 3 index of the board, like TERMINAL_TABLE,
+ *  so a position is answered with one lookup.  Either player may move first, so both are stored.
+ */
+
+#pragma once
+#ifndef TABLEBASE
+#define TABLEBASE
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "util.h"
+#include "board.h"
+#include "game.h"
+
+// Number of entries: each 3x3 board with Player X (first half) or Player O (second half) to move.
+const int TABLEBASE_ENTRIES = 2 * TERNARY_BOARDS;
+
+// distance of positions that cannot be reached from the empty board.
+const uint8_t UNREACHABLE = 0xff;
+
+// Identifies tablebase files, and changes if the layout does.
+const char TABLEBASE_MAGIC[4] = {'T', 'T', 'T', 'B'};
+const uint32_t TABLEBASE_VERSION = 1;
+
+struct TablebaseHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entries;  // TABLEBASE_ENTRIES
+};
+
+struct TablebaseEntry {
+    int8_t value = DRAW;            // WIN, DRAW, or LOSS for the player to move, with perfect play
+    uint8_t distance = UNREACHABLE; // Moves to the end of the game.  Wins are as quick and losses as slow as can be.
+    uint16_t bestMoves = 0;         // Bit TicTacToe::toCell(row, col) is set for every move that keeps the value and distance
+};
+
+/**
+ *  Returns the index of the entry of the given board with the player of the given code to move.
+ */
+inline int tablebaseIndex(const TicTacToe& board, int currentPlayer) {
+    return ((currentPlayer == PLAYER_X_CODE) ? 0 : TERNARY_BOARDS) + ternaryIndex(board);
+}
+
+/**
+ *  Solve every position reachable from the empty board by retrograde analysis.
+ *  Positions are found going forward, then solved from the fullest boards back to the empty one.
+ *  Returns TABLEBASE_ENTRIES entries.  Unreachable positions have distance UNREACHABLE.
+ */
+std::vector<TablebaseEntry> createTablebase();
+
+/**
+ *  Write the @param entries of createTablebase() to the file at @param path.
+ *  Return true if successful, false otherwise.
+ */
+bool writeTablebase(const std::string& path, const std::vector<TablebaseEntry>& entries);
+
+/**
+ *  A tablebase file mapped into memory, read only.  Pages are loaded as they are looked up and shared between processes.
+ */
+class Tablebase {
+    public:
+        Tablebase() {}
+        ~Tablebase();
+
+        Tablebase(const Tablebase&) = delete;
+        Tablebase& operator=(const Tablebase&) = delete;
+
+        /**
+         *  Map the tablebase file at @param path, unmapping any file mapped before.
+         *  Return true if successful, false if the file cannot be read or is not a tablebase.
+         */
+        bool open(const std::string& path);
+
+        // Returns whether a file is mapped.
+        bool isOpen() const { return entries != NULL; }
+
+        /**
+         *  Return the entry of the given board with the player of the given code to move,
+         *  or NULL if no file is mapped or the position cannot be reached.
+         */
+        const TablebaseEntry* lookup(const TicTacToe& board, int currentPlayer) const;
+
+        /**
+         *  Return one of the best moves of the given entry at random.  The entry must have a move.
+         */
+        static moveRCPair pickMove(const TablebaseEntry* entry);
+
+    private:
+        void* mapping = NULL;
+        size_t mappingSize = 0;
+        const TablebaseEntry* entries = NULL;
+
+        void close();
+};
+
+#endif  // TABLEBASE
@@ -0,0 +1,158 @@
+/**
+ * @file test_board.cpp
+ * @author Vincent Li
+ * Test functionalities of board.cpp and the line tables of board.h.
+ */
+
+#include "board.h"
+
+
+#include <iostream>
+#include <assert.h>
+#include <algorithm>
+#include <vector>
+
+// Returns the next number of a fixed sequence, for masks that are the same every run
+uint64_t nextNumber(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state ^ (state >> 29);
+}
+
+/**
+ * Returns the masks of every row, column, and diagonal of K boxes of @param Board, built box by box.
+ */
+template<class Board>
+std::vector<typename Board::Mask> referenceLines() {
+    const int steps[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    std::vector<typename Board::Mask> lines;
+    for(const auto& step : steps) {
+        for(int row = 0; row < Board::ROWS; row++) {
+            for(int col = 0; col < Board::COLS; col++) {
+                int lastRow = row + (Board::IN_A_ROW - 1) * step[0];
+                int lastCol = col + (Board::IN_A_ROW - 1) * step[1];
+                if(lastRow >= Board::ROWS || lastCol < 0 || lastCol >= Board::COLS) continue;
+
+                Board line;
+                for(int i = 0; i < Board::IN_A_ROW; i++) line.set(row + i * step[0], col + i * step[1], PLAYER_X_MARK);
+                lines.push_back(line.x);
+            }
+        }
+    }
+    return lines;
+}
+
+/**
+ * Assert that the line tables of @param Board are the rows, columns, and diagonals of K boxes,
+ * and that hasLine() finds one in the masks that cover a line.
+ */
+template<class Board>
+void checkLines() {
+    typedef typename Board::Mask Mask;
+    assert(countBits(Board::FULL) == Board::CELLS);
+
+    std::vector<Mask> expected = referenceLines<Board>();
+    std::vector<Mask> lines(Board::LINES.begin(), Board::LINES.end());
+    assert((int)lines.size() == Board::NUM_LINES);
+    std::sort(expected.begin(), expected.end());
+    std::sort(lines.begin(), lines.end());
+    assert(lines == expected);
+
+    // Each box lists the lines through it
+    for(int cell = 0; cell < Board::CELLS; cell++) {
+        int count = 0;
+        for(int l = 0; l < Board::NUM_LINES; l++) {
+            if((Board::LINES[l] >> cell) & 1) assert(Board::CELL_LINES[cell][++count] == l);
+        }
+        assert(Board::CELL_LINES[cell][0] == count);
+    }
+
+    // Every mask of the small boards, and a fixed sequence of masks of each fill on the larger ones
+    uint64_t state = Board::CELLS;
+    int masks = (Board::CELLS <= 16) ? (1 << Board::CELLS) : 30000;
+    for(int i = 0; i < masks; i++) {
+        Mask marks = (Board::CELLS <= 16) ? Mask(i) : Mask(nextNumber(state));
+        if(Board::CELLS > 16 && i % 3 == 1) marks &= Mask(nextNumber(state));
+        if(Board::CELLS > 16 && i % 3 == 2) marks |= Mask(nextNumber(state));
+        marks &= Board::FULL;
+        bool covered = false;
+        for(Mask line : Board::LINES) covered = covered || (marks & line) == line;
+        assert(Board::hasLine(marks) == covered);
+    }
+}
+
+void test_lines() {
+    checkLines<TicTacToe>();
+    checkLines<Board4x4x3>();
+    checkLines<Board4x4x4>();
+    checkLines<Board5x5x4>();
+    checkLines<Board5x5x5>();
+    checkLines<Board7x7x4>();
+    checkLines<Board7x7x5>();
+
+    // K in a row wins on a larger board, and one less does not
+    Board5x5x4 bb;
+    for(int i = 0; i < 3; i++) bb.set(1 + i, 3 - i, PLAYER_O_MARK);
+    assert(!Board5x5x4::hasLine(bb.o));
+    bb.set(4, 0, PLAYER_O_MARK);
+    assert(Board5x5x4::hasLine(bb.o));
+    assert(!Board5x5x4::hasLine(bb.x));
+}
+
+void test_marks() {
+    TicTacToe bb;
+    assert(bb.x == 0 && bb.o == 0);
+    bb.set(0, 0, PLAYER_X_MARK);
+    bb.set(1, 2, PLAYER_O_MARK);
+    bb.set(2, 1, PLAYER_X_MARK);
+
+    // Each box is its own bit of its player's mask
+    assert(bb.x == ((1 << TicTacToe::toCell(0, 0)) | (1 << TicTacToe::toCell(2, 1))));
+    assert(bb.o == 1 << TicTacToe::toCell(1, 2));
+    assert(bb.marks(PLAYER_X_MARK) == bb.x);
+    assert(bb.marks(PLAYER_O_MARK) == bb.o);
+    assert(bb.occupied() == (bb.x | bb.o));
+    assert(bb.get(0, 0) == PLAYER_X_MARK);
+    assert(bb.get(1, 2) == PLAYER_O_MARK);
+    assert(bb.get(1, 1) == CLEAR);
+    assert(TicTacToe::toMove(TicTacToe::toCell(2, 1)) == std::make_pair(2, 1));
+
+    // Boards are equal by their masks
+    const char grid[3][3] = {{PLAYER_X_MARK, CLEAR, CLEAR}, {CLEAR, CLEAR, PLAYER_O_MARK}, {CLEAR, PLAYER_X_MARK, CLEAR}};
+    assert(toBitBoard(grid) == bb);
+    assert(TicTacToe() != bb);
+
+    // Clearing a box clears it from either mask
+    bb.clear(1, 2);
+    bb.clear(0, 0);
+    assert(bb.x == 1 << TicTacToe::toCell(2, 1) && bb.o == 0);
+
+    // The last box of a 7x7 board is past 32 bits
+    Board7x7x4 large;
+    large.set(6, 6, PLAYER_O_MARK);
+    assert(large.o == Board7x7x4::Mask(1) << 48);
+    assert(large.get(6, 6) == PLAYER_O_MARK);
+}
+
+void test_set() {
+    GameBoard<TicTacToe> board;
+    assert(board.set(1, 1, PLAYER_X_MARK));
+    assert(board.state.get(1, 1) == PLAYER_X_MARK);
+
+    // Marked boxes and boxes off the board are not set
+    assert(!board.set(1, 1, PLAYER_O_MARK));
+    assert(!board.set(3, 0, PLAYER_O_MARK));
+    assert(!board.set(0, -1, PLAYER_O_MARK));
+    assert(board.state.o == 0);
+
+    GameBoard<Board5x5x4> large;
+    assert(large.set(4, 4, PLAYER_O_MARK));
+    assert(!large.set(5, 0, PLAYER_O_MARK));
+}
+
+int main(int argc, char** argv) {
+    test_lines();
+    test_marks();
+    test_set();
+
+    return 0;
+}
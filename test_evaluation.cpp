@@ -0,0 +1,163 @@
+/**
+ * @file test_evaluation.cpp
+ * @author Vincent Li
+ * Test the line heuristic tables of evaluation.h and the batch kernels of batcheval.h against the heuristic scored one box at a time.
+ */
+
+#include "evaluation.h"
+#include "batcheval.h"
+
+
+#include <iostream>
+#include <assert.h>
+#include <vector>
+
+/**
+ * Returns the line heuristic of @param board for the player with @param mark, walking the boxes of every line of K in a row.
+ * A line of only own marks scores 1 for one and 3 for more, a line of only opponent marks the negation, and the rest 0.
+ */
+template<int R, int C, int K>
+int referenceHeuristic(const BitBoard<R, C, K>& board, char mark) {
+    const int steps[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    int h = 0;
+    for(const auto& step : steps) {
+        for(int row = 0; row < R; row++) {
+            for(int col = 0; col < C; col++) {
+                int lastRow = row + (K - 1) * step[0];
+                int lastCol = col + (K - 1) * step[1];
+                if(lastRow >= R || lastCol < 0 || lastCol >= C) continue;
+
+                int own = 0;
+                int opp = 0;
+                for(int i = 0; i < K; i++) {
+                    char box = board.get(row + i * step[0], col + i * step[1]);
+                    own += (box == mark);
+                    opp += (box != mark && box != CLEAR);
+                }
+                if(own > 0 && opp == 0) h += (own == 1) ? 1 : 3;
+                if(opp > 0 && own == 0) h -= (opp == 1) ? 1 : 3;
+            }
+        }
+    }
+    return h;
+}
+
+// Returns the next number of a fixed sequence, for boards that are the same every run
+uint64_t nextNumber(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state ^ (state >> 29);
+}
+
+/**
+ * Returns @param count boards of @param Board with each box X, O, or clear at random, the same ones every run.
+ */
+template<class Board>
+std::vector<Board> randomBoards(int count, uint64_t seed) {
+    std::vector<Board> boards;
+    uint64_t state = seed;
+    for(int i = 0; i < count; i++) {
+        Board board;
+        for(int cell = 0; cell < Board::CELLS; cell++) {
+            int box = nextNumber(state) % 3;
+            if(box == 1) board.set(cell / Board::COLS, cell % Board::COLS, PLAYER_X_MARK);
+            else if(box == 2) board.set(cell / Board::COLS, cell % Board::COLS, PLAYER_O_MARK);
+        }
+        boards.push_back(board);
+    }
+    return boards;
+}
+
+void test_boardScores() {
+    // Every 3x3 board, by its base 3 index
+    for(int index = 0; index < TERNARY_BOARDS; index++) {
+        TicTacToe board;
+        int digits = index;
+        for(int cell = 0; cell < TicTacToe::CELLS; cell++, digits /= 3) {
+            if(digits % 3 == 1) board.set(cell / 3, cell % 3, PLAYER_X_MARK);
+            else if(digits % 3 == 2) board.set(cell / 3, cell % 3, PLAYER_O_MARK);
+        }
+        assert(ternaryIndex(board) == index);
+
+        int x = referenceHeuristic(board, PLAYER_X_MARK);
+        assert(BOARD_SCORES.score[index] == x);
+        assert(evaluate<PLAYER_X_MARK>(board) == x);
+        assert(evaluate<PLAYER_O_MARK>(board) == referenceHeuristic(board, PLAYER_O_MARK));
+    }
+
+    // Set bits of every 9-bit mask
+    for(int mask = 0; mask <= TicTacToe::FULL; mask++) assert(BOARD_SCORES.bits[mask] == countBits((uint16_t)mask));
+}
+
+/**
+ * Assert that evaluate() scores @param count random boards of @param Board like referenceHeuristic(),
+ * from the board and from the line counts of Game, for both players.
+ */
+template<class Board>
+void checkEvaluate(int count, uint64_t seed) {
+    for(const Board& board : randomBoards<Board>(count, seed)) {
+        int x = referenceHeuristic(board, PLAYER_X_MARK);
+        int o = referenceHeuristic(board, PLAYER_O_MARK);
+        assert(evaluate<PLAYER_X_MARK>(board) == x);
+        assert(evaluate<PLAYER_O_MARK>(board) == o);
+
+        Game<Board> game(board, PLAYER_X_CODE);
+        assert(evaluate<PLAYER_X_MARK>(game.tracker) == x);
+        assert(evaluate<PLAYER_O_MARK>(game.tracker) == o);
+    }
+}
+
+void test_evaluate() {
+    checkEvaluate<TicTacToe>(200, 1);
+    checkEvaluate<Board4x4x3>(1000, 2);
+    checkEvaluate<Board5x5x4>(1000, 3);
+    checkEvaluate<Board7x7x4>(1000, 4);
+    checkEvaluate<Board7x7x5>(1000, 5);
+}
+
+/**
+ * Assert that evaluateBatch() with @param kernel scores @param count random boards of @param Board like referenceHeuristic(),
+ * for both players.  Odd counts leave boards over for the scalar loop.
+ */
+template<class Board>
+void checkBatch(int kernel, int count, uint64_t seed) {
+    std::vector<Board> boards = randomBoards<Board>(count, seed);
+    std::vector<int> scores(count);
+    evaluateBatch<PLAYER_X_MARK>(boards.data(), count, scores.data(), kernel);
+    for(int i = 0; i < count; i++) assert(scores[i] == referenceHeuristic(boards[i], PLAYER_X_MARK));
+    evaluateBatch<PLAYER_O_MARK>(boards.data(), count, scores.data(), kernel);
+    for(int i = 0; i < count; i++) assert(scores[i] == referenceHeuristic(boards[i], PLAYER_O_MARK));
+}
+
+/**
+ * Assert that evaluateBatch() with @param kernel scores every board size like referenceHeuristic().
+ */
+void checkKernel(int kernel) {
+    checkBatch<TicTacToe>(kernel, 101, 6);
+    checkBatch<Board4x4x3>(kernel, 1001, 7);
+    checkBatch<Board5x5x4>(kernel, 1002, 8);
+    checkBatch<Board7x7x4>(kernel, 1003, 9);
+    checkBatch<Board7x7x5>(kernel, 1001, 10);
+    // Batches smaller than a kernel's width are scored one at a time
+    checkBatch<Board7x7x4>(kernel, 3, 11);
+}
+
+void test_evaluateBatch() {
+    checkKernel(BATCH_SCALAR);
+    checkKernel(BATCH_BEST);
+#if defined(__x86_64__)
+    checkKernel(BATCH_SSE2);
+    // The AVX2 kernel can only run on CPUs that have it
+    if(__builtin_cpu_supports("avx2")) checkKernel(BATCH_AVX2);
+#if defined(VERBOSE) || defined(DEBUG)
+    else std::cout << "Skipping the AVX2 kernel, which this CPU does not have" << std::endl;
+#endif  // defined(VERBOSE) || defined(DEBUG)
+#endif  // defined(__x86_64__)
+}
+
+int main(int argc, char** argv) {
+    test_boardScores();
+    test_evaluate();
+    test_evaluateBatch();
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file test_game.cpp
+ * @author Vincent Li
+ * Test functionalities of game.cpp.
+ */
+
+#include "game.h"
+
+
+#include <iostream>
+#include <assert.h>
+#include <numeric>
+
+// Returns the board of the given base 3 index, whose digit for each box is 0 (CLEAR), 1 (X), or 2 (O)
+TicTacToe fromTernary(int index) {
+    TicTacToe board;
+    for(int cell = 0; cell < 9; cell++, index /= 3) {
+        if(index % 3 == 1) board.set(cell / 3, cell % 3, PLAYER_X_MARK);
+        else if(index % 3 == 2) board.set(cell / 3, cell % 3, PLAYER_O_MARK);
+    }
+    return board;
+}
+
+void test_terminalTable() {
+    // Every board's result is the one found by scanning its lines
+    for(int index = 0; index < TERNARY_BOARDS; index++) {
+        TicTacToe board = fromTernary(index);
+        assert(ternaryIndex(board) == index);
+
+        int expected = ONGOING;
+        if(playerWins(PLAYER_X_MARK, board)) expected = PLAYER_X_WON;
+        else if(playerWins(PLAYER_O_MARK, board)) expected = PLAYER_O_WON;
+        else if(isDraw(board)) expected = DRAW;
+        assert(terminalState(board) == expected);
+    }
+
+    // A won board that fills the last box is a win, not a draw
+    const char won[3][3] = {{PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_X_MARK},
+                            {PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_O_MARK},
+                            {PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_X_MARK}};
+    assert(terminalState(toBitBoard(won)) == PLAYER_X_WON);
+    const char drawn[3][3] = {{PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_X_MARK},
+                              {PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_O_MARK},
+                              {PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_X_MARK}};
+    assert(terminalState(toBitBoard(drawn)) == DRAW);
+    assert(terminalState(TicTacToe()) == ONGOING);
+}
+
+/**
+ * Assert that the line counts, clear boxes, result, and hashes that @param game updated move by move are those of its board counted again.
+ * Only the symmetries that the game hashes are checked, and without them the board is its own canonical form.
+ */
+template<class Board>
+void checkCounts(const Game<Board>& game) {
+    typename Board::Tracker counted;
+    counted.reset(game.board.state);
+    for(int side = 0; side < 2; side++) {
+        for(int l = 0; l < Board::NUM_LINES; l++) assert(game.tracker.lineCounts[side][l] == counted.lineCounts[side][l]);
+    }
+    assert(game.tracker.emptyCells == counted.emptyCells);
+    assert(game.result == terminalState(game.board.state));
+    assert(game.hash() == zobristHash(game.board.state, game.currentPlayer));
+    for(int t = 0; t < game.hashedSymmetries; t++) assert(game.boardHashes[t] == zobristBoardHash(transformBoard(game.board.state, t)));
+    if(game.hashedSymmetries == 1) assert(game.canonicalSymmetry() == 0);
+}
+
+/**
+ * Fill @param Board in orders that step through the boxes, playing on after a win as searches may,
+ * and assert that each move keeps the counts of checkCounts() and that undoing every move restores the empty game.
+ * Every other order hashes the symmetries of the board as well.
+ */
+template<class Board>
+void checkMakeMove() {
+    for(int start = 0; start < Board::CELLS; start += 3) {
+        for(int step = 1; step < Board::CELLS; step += 2) {
+            if(std::gcd(step, Board::CELLS) != 1) continue;
+            Board empty;
+            Game<Board> game(empty, PLAYER_X_CODE);
+            game.hashSymmetries(step % 4 == 1);
+            assert(game.hashedSymmetries == ((step % 4 == 1) ? Board::SYMMETRIES : 1));
+            for(int i = 0; i < Board::CELLS; i++) {
+                moveRCPair move = Board::toMove((start + i * step) % Board::CELLS);
+                char mark = codeToMark(game.currentPlayer);
+                assert(game.makeMove(move.row, move.column) == game.result);
+                assert(game.board.state.get(move.row, move.column) == mark);
+                assert(game.turns == i + 1 && (int)game.history.size() == i + 1);
+                checkCounts(game);
+            }
+
+            for(int i = 0; i < Board::CELLS; i++) {
+                game.undoMove();
+                checkCounts(game);
+            }
+            assert(game.board.state == empty);
+            assert(game.currentPlayer == PLAYER_X_CODE);
+            assert(game.turns == 0 && game.history.empty());
+            assert(game.result == ONGOING);
+        }
+    }
+}
+
+void test_makeMove() {
+    checkMakeMove<TicTacToe>();
+    checkMakeMove<Board4x4x3>();
+    checkMakeMove<Board5x5x4>();
+}
+
+int main(int argc, char** argv) {
+    test_terminalTable();
+    test_makeMove();
+
+    return 0;
+}
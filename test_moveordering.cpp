@@ -0,0 +1,127 @@
+/**
+ * @file test_moveordering.cpp
+ * @author Vincent Li
+ * Test the move ordering heuristics of moveordering.h.
+ */
+
+#include "moveordering.h"
+
+
+#include <iostream>
+#include <assert.h>
+
+// X can win at 0,2 and must block O at 1,2
+TicTacToe winOrBlock() {
+    TicTacToe bb;
+    bb.set(0, 0, PLAYER_X_MARK);
+    bb.set(0, 1, PLAYER_X_MARK);
+    bb.set(1, 0, PLAYER_O_MARK);
+    bb.set(1, 1, PLAYER_O_MARK);
+    return bb;
+}
+
+void test_staticPrior() {
+    // The center is on 4 lines, corners on 3, and edges on 2
+    TicTacToe bb;
+    assert(staticPrior(bb, 4) == 4 && staticPrior(bb, 0) == 3 && staticPrior(bb, 1) == 2);
+
+    // Ultimate boxes add the lines through their sub-board in the meta-board
+    UltimateBoard ub;
+    assert(staticPrior(ub, 9 * 4 + 4) == 8);
+    assert(staticPrior(ub, 9 * 0 + 1) == 5);
+}
+
+void test_tacticalScore() {
+    TicTacToe bb = winOrBlock();
+    assert(tacticalScore(bb, 2, PLAYER_X_MARK, PLAYER_O_MARK) == 2);
+    assert(tacticalScore(bb, 5, PLAYER_X_MARK, PLAYER_O_MARK) == 1);
+    assert(tacticalScore(bb, 8, PLAYER_X_MARK, PLAYER_O_MARK) == 0);
+    // For O, the same boxes win and block the other way around
+    assert(tacticalScore(bb, 5, PLAYER_O_MARK, PLAYER_X_MARK) == 2);
+    assert(tacticalScore(bb, 2, PLAYER_O_MARK, PLAYER_X_MARK) == 1);
+
+    // O can win sub-board 0 at 0,2
+    UltimateBoard ub;
+    ub.set(0, 0, PLAYER_O_MARK);
+    ub.set(0, 1, PLAYER_O_MARK);
+    ub.set(1, 1, PLAYER_X_MARK);
+    assert(tacticalScore(ub, UltimateBoard::toCell(0, 2), PLAYER_O_MARK, PLAYER_X_MARK) == 2);
+    assert(tacticalScore(ub, UltimateBoard::toCell(0, 2), PLAYER_X_MARK, PLAYER_O_MARK) == 1);
+    assert(tacticalScore(ub, UltimateBoard::toCell(2, 2), PLAYER_X_MARK, PLAYER_O_MARK) == 0);
+
+    // A sub-board that is already won has nothing left to win or block
+    ub.set(0, 3, PLAYER_X_MARK);
+    ub.set(0, 4, PLAYER_X_MARK);
+    ub.set(0, 5, PLAYER_X_MARK);
+    ub.set(1, 3, PLAYER_O_MARK);
+    ub.set(1, 4, PLAYER_O_MARK);
+    assert(tacticalScore(ub, UltimateBoard::toCell(1, 5), PLAYER_O_MARK, PLAYER_X_MARK) == 0);
+}
+
+void test_sortByScore() {
+    // Highest first, and equal scores keep their order
+    int items[6] = {0, 1, 2, 3, 4, 5};
+    int scores[6] = {1, 5, 1, 7, 5, 0};
+    MoveOrderer<TicTacToe>::sortByScore(items, scores, 6);
+    int sorted[6] = {3, 1, 4, 0, 2, 5};
+    for(int i = 0; i < 6; i++) assert(items[i] == sorted[i]);
+    for(int i = 1; i < 6; i++) assert(scores[i - 1] >= scores[i]);
+}
+
+void test_record() {
+    MoveOrderer<TicTacToe> ordering;
+    ordering.record(6, PLAYER_X_MARK, 4, 3, true, 0);
+    ordering.record(7, PLAYER_X_MARK, 4, 2, true, 1);
+    ordering.record(7, PLAYER_X_MARK, 4, 1, true, 2);
+    ordering.record(8, PLAYER_X_MARK, 4, 5, false, -1);
+    assert(ordering.interiorNodes == 4 && ordering.cutoffs == 3 && ordering.firstMoveCutoffs == 1);
+
+    // The newest cutoff move is the first killer of its ply, and a repeat does not push out the other
+    assert(ordering.killers[4][0] == 7 && ordering.killers[4][1] == 6);
+    assert(ordering.killers[3][0] == -1);
+    // History gains the square of the depth left, for the player that moved
+    assert(ordering.history[0][6] == 9 && ordering.history[0][7] == 5 && ordering.history[0][8] == 0);
+    assert(ordering.history[1][6] == 0);
+
+    // A new search forgets the killers and counts and halves the history
+    ordering.newSearch();
+    assert(ordering.killers[4][0] == -1 && ordering.killers[4][1] == -1);
+    assert(ordering.history[0][6] == 4 && ordering.history[0][7] == 2);
+    assert(ordering.interiorNodes == 0 && ordering.cutoffs == 0);
+}
+
+void test_score() {
+    // The win, the block, the killer, then the corner before the edge
+    TicTacToe bb = winOrBlock();
+    MoveOrderer<TicTacToe> ordering;
+    ordering.record(6, PLAYER_X_MARK, 4, 1, true, 1);
+    moveRCPair moves[5] = {{2, 1}, {2, 2}, {2, 0}, {1, 2}, {0, 2}};
+    int scores[5];
+    ordering.scoreMoves(bb, moves, 5, PLAYER_X_MARK, PLAYER_O_MARK, 4, scores);
+    MoveOrderer<TicTacToe>::sortByScore(moves, scores, 5);
+    moveRCPair sorted[5] = {{0, 2}, {1, 2}, {2, 0}, {2, 2}, {2, 1}};
+    for(int i = 0; i < 5; i++) assert(moves[i] == sorted[i]);
+
+    // Without heuristics every score is 0, so the order stays
+    ordering.moveOrdering = 0;
+    ordering.scoreMoves(bb, sorted, 5, PLAYER_X_MARK, PLAYER_O_MARK, 4, scores);
+    for(int i = 0; i < 5; i++) assert(scores[i] == 0);
+
+    // Each flag turns on its own heuristic
+    ordering.moveOrdering = ORDER_STATIC;
+    assert(ordering.score(bb, 8, PLAYER_X_MARK, PLAYER_O_MARK, 4) == 3);
+    ordering.moveOrdering = ORDER_KILLERS;
+    assert(ordering.score(bb, 6, PLAYER_X_MARK, PLAYER_O_MARK, 4) > 0 && ordering.score(bb, 6, PLAYER_X_MARK, PLAYER_O_MARK, 3) == 0);
+    ordering.moveOrdering = ORDER_HISTORY;
+    assert(ordering.score(bb, 6, PLAYER_X_MARK, PLAYER_O_MARK, 0) > 0 && ordering.score(bb, 6, PLAYER_O_MARK, PLAYER_X_MARK, 0) == 0);
+}
+
+int main(int argc, char** argv) {
+    test_staticPrior();
+    test_tacticalScore();
+    test_sortByScore();
+    test_record();
+    test_score();
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file test_nodearena.cpp
+ * @author Vincent Li
+ * Test the node arena of nodearena.h.
+ */
+
+#include "nodearena.h"
+
+
+#include <iostream>
+#include <assert.h>
+
+struct TestNode {
+    int value;
+    uint32_t next;
+};
+
+// Blocks of 8 nodes, so a few nodes span blocks
+typedef NodeArena<TestNode, 3> SmallArena;
+
+void test_allocate() {
+    SmallArena arena;
+    assert(arena.numOfBlocks() == 0 && arena.live() == 0);
+
+    // Nodes come one after another, value-initialized
+    for(uint32_t i = 0; i < 6; i++) {
+        uint32_t index = arena.allocate();
+        assert(index == i);
+        assert(arena[index].value == 0 && arena[index].next == 0);
+        arena[index].value = i + 1;
+    }
+    assert(arena.numOfBlocks() == 1 && arena.live() == 6);
+
+    // A run that does not fit in the rest of the block starts the next one
+    uint32_t run = arena.allocate(4);
+    assert(run == 8);
+    for(uint32_t i = run; i < run + 4; i++) assert(&arena[i] == &arena[run] + (i - run));
+    assert(arena.numOfBlocks() == 2 && arena.live() == 10 && arena.peak() == 10);
+
+    // A run that fits goes right after, and a whole block is one run
+    assert(arena.allocate(4) == 12);
+    assert(arena.allocate(SmallArena::BLOCK_NODES) == 16);
+    assert(arena.numOfBlocks() == 3 && arena.memoryUsed() == 3 * SmallArena::BLOCK_NODES * sizeof(TestNode));
+
+    // Nodes do not move as the arena grows
+    TestNode* first = &arena[0];
+    for(int i = 0; i < 100; i++) arena.allocate();
+    assert(&arena[0] == first);
+    for(uint32_t i = 0; i < 6; i++) assert(arena[i].value == (int)i + 1);
+}
+
+void test_release() {
+    SmallArena arena;
+    for(int i = 0; i < 20; i++) arena[arena.allocate()].value = 7;
+    size_t blocks = arena.numOfBlocks();
+    TestNode* first = &arena[0];
+
+    // Released nodes are handed out again from the same blocks, cleared
+    arena.release();
+    assert(arena.live() == 0 && arena.peak() == 20 && arena.numOfBlocks() == blocks);
+    for(int i = 0; i < 20; i++) {
+        uint32_t index = arena.allocate();
+        assert(index == (uint32_t)i && arena[index].value == 0);
+    }
+    assert(&arena[0] == first && arena.numOfBlocks() == blocks);
+
+    // Only a larger tree takes more blocks
+    arena.release();
+    for(int i = 0; i < 30; i++) arena.allocate();
+    assert(arena.numOfBlocks() > blocks && arena.peak() == 30);
+
+    arena.freeMemory();
+    assert(arena.numOfBlocks() == 0 && arena.live() == 0 && arena.memoryUsed() == 0);
+    assert(arena.allocate() == 0 && arena.numOfBlocks() == 1);
+}
+
+void test_swap() {
+    SmallArena a;
+    SmallArena b;
+    for(int i = 0; i < 3; i++) a[a.allocate()].value = i + 1;
+    b[b.allocate()].value = 9;
+
+    a.swap(b);
+    assert(a.live() == 1 && a[0].value == 9);
+    assert(b.live() == 3 && b[2].value == 3 && b.peak() == 3);
+}
+
+int main(int argc, char** argv) {
+    test_allocate();
+    test_release();
+    test_swap();
+
+    return 0;
+}
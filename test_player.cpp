@@ -0,0 +1,58 @@
+/**
+ * @file test_player.cpp
+ * @author Vincent Li
+ * Test functionalities of player.cpp.
+ */
+
+#include "player.h"
+
+
+#include <iostream>
+#include <assert.h>
+#include <vector>
+
+void test_getValidActions() {
+    TicTacToe bb;
+    bb.set(0, 1, PLAYER_X_MARK);
+    bb.set(1, 1, PLAYER_O_MARK);
+    bb.set(2, 2, PLAYER_X_MARK);
+
+    // The clear boxes, in row-major order
+    TicTacToe::MoveSet actions = getValidActions(bb);
+    assert(actions.size() == 6);
+    assert(!actions.empty());
+    std::vector<moveRCPair> moves;
+    for(moveRCPair move : actions) moves.push_back(move);
+    std::vector<moveRCPair> expected = {{0, 0}, {0, 2}, {1, 0}, {1, 2}, {2, 0}, {2, 1}};
+    assert(moves == expected);
+    for(int i = 0; i < actions.size(); i++) assert(actions.nth(i) == expected[i]);
+
+    actions.clear();
+    assert(actions.empty() && actions.size() == 0);
+    assert(!(actions.begin() != actions.end()));
+
+    // A full board has no moves
+    const char full[3][3] = {{PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_X_MARK},
+                             {PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_O_MARK},
+                             {PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_X_MARK}};
+    assert(getValidActions(toBitBoard(full)).empty());
+    assert(getValidActions(TicTacToe()).size() == 9);
+
+    // The moves of a 7x7 board reach past 32 bits, and stop at its last box
+    Board7x7x4 large;
+    for(int row = 0; row < 7; row++) {
+        for(int col = 0; col < 7; col++) {
+            if(row != 6 || col < 5) large.set(row, col, PLAYER_X_MARK);
+        }
+    }
+    Board7x7x4::MoveSet last = getValidActions(large);
+    assert(last.size() == 2);
+    assert(last.nth(0) == std::make_pair(6, 5));
+    assert(last.nth(1) == std::make_pair(6, 6));
+}
+
+int main(int argc, char** argv) {
+    test_getValidActions();
+
+    return 0;
+}
@@ -0,0 +1,351 @@
+/**
+ * @file test_playerminimax.cpp
+ * @author Vincent Li
+ * Test functionalities of playerminimax.cpp.
+ */
+
+#include "playerminimax.h"
+
+
+#include <iostream>
+#include <assert.h>
+#include <vector>
+
+// Returns the next number of a fixed sequence, for positions that are the same every run
+uint64_t nextNumber(uint64_t& state) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state ^ (state >> 29);
+}
+
+/**
+ * Returns @param count positions of @param Board reached by random moves from the empty board, the same ones every run.
+ * Finished games are left out.
+ */
+template<class Board>
+std::vector<Board> randomPositions(int count, uint64_t seed) {
+    std::vector<Board> positions;
+    uint64_t state = seed;
+    while((int)positions.size() < count) {
+        Board board;
+        int moves = nextNumber(state) % (Board::CELLS - 1);
+        char mark = PLAYER_X_MARK;
+        for(int i = 0; i < moves && terminalState(board) == ONGOING; i++) {
+            typename Board::MoveSet validActions = getValidActions(board);
+            moveRCPair move = validActions.nth(nextNumber(state) % validActions.size());
+            board.set(move.row, move.column, mark);
+            mark = (mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK;
+        }
+        if(terminalState(board) == ONGOING) positions.push_back(board);
+    }
+    return positions;
+}
+
+// Returns the code of the player to move on @param board, with Player X moving first
+template<class Board>
+int playerToMove(const Board& board) {
+    return (countBits(board.x) == countBits(board.o)) ? PLAYER_X_CODE : PLAYER_O_CODE;
+}
+
+/**
+ * Returns the move and value of @param player at @param board, to its depth limit, from a fresh search of rootSearch().
+ * The player's settings pick the driver, and MTD(f) starts from @param guess.
+ */
+template<class Board>
+std::pair<moveRCPair, int> searchInPlace(AIPlayerMinimax<Board>& player, const Board& board, int guess = 0) {
+    Game<Board> game(board, player.code);
+    game.hashSymmetries(player.useSymmetry);
+    player.table.clear();
+    player.ordering.newSearch();
+    player.treeSize = 0;
+    player.rootMove = std::make_pair(-1, -1);
+    return player.rootSearch(game, player.depthLimit * 2, guess, std::make_pair(-1, -1));
+}
+
+/**
+ * Returns the move and value of @param player at @param board, to its depth limit, from minimaxSearch() on a game tree,
+ * as chooseMove() searches without inPlace.
+ */
+template<class Board>
+std::pair<moveRCPair, int> searchTree(AIPlayerMinimax<Board>& player, const Board& board) {
+    int depth = player.depthLimit * 2;
+    Game<Board> game(board, player.code);
+    game.hashSymmetries(player.useSymmetry);
+    player.ordering.newSearch();
+    typename AIPlayerMinimax<Board>::Node* tree = player.createGameTree(std::make_pair(-1, -1), game, depth);
+    std::pair<moveRCPair, int> result = player.minimaxSearch(tree, depth, -1000, 1000, true, std::make_pair(-1, -1));
+    player.deleteTree();
+    return result;
+}
+
+/**
+ * Assert that negamaxSearch() returns the move and value of minimaxSearch() on the game tree,
+ * at @param count random positions of @param Board to @param depthLimit, with and without the table and symmetry.
+ */
+template<class Board>
+void checkNegamax(int count, int depthLimit, uint64_t seed) {
+    AIPlayerMinimax<Board> playerX(PLAYER_X_CODE, PLAYER_X_MARK, depthLimit);
+    AIPlayerMinimax<Board> playerO(PLAYER_O_CODE, PLAYER_O_MARK, depthLimit);
+    for(const Board& board : randomPositions<Board>(count, seed)) {
+        AIPlayerMinimax<Board>& player = (playerToMove(board) == PLAYER_X_CODE) ? playerX : playerO;
+        for(bool settings : {true, false}) {
+            player.useTable = settings;
+            player.useSymmetry = settings;
+            std::pair<moveRCPair, int> reference = searchTree(player, board);
+            std::pair<moveRCPair, int> inPlace = searchInPlace(player, board);
+            assert(inPlace.second == reference.second);
+            assert(inPlace.first == reference.first);
+        }
+    }
+}
+
+void test_negamaxSearch() {
+    // The positions of the Monte Carlo tests: X can win at 0,2 or block O at 2,2
+    TicTacToe bb;
+    bb.set(0, 0, PLAYER_X_MARK);
+    bb.set(0, 1, PLAYER_X_MARK);
+    bb.set(2, 0, PLAYER_O_MARK);
+    bb.set(2, 1, PLAYER_O_MARK);
+    AIPlayerMinimax<TicTacToe> playerX(PLAYER_X_CODE, PLAYER_X_MARK, 0);
+    assert(searchInPlace(playerX, bb) == searchTree(playerX, bb));
+    bb.clear(0, 1);
+    assert(searchInPlace(playerX, bb) == searchTree(playerX, bb));
+
+    // Full depth on the 3x3 board, and the depth limit on larger boards
+    checkNegamax<TicTacToe>(40, 0, 1);
+    checkNegamax<Board4x4x3>(20, 2, 2);
+    checkNegamax<Board5x5x4>(10, 2, 3);
+}
+
+/**
+ * Assert that negamaxSearch() and minimaxSearch() return the same move and value with and without move ordering,
+ * at @param count random positions of @param Board to @param depthLimit, with and without the table.
+ */
+template<class Board>
+void checkOrdering(int count, int depthLimit, uint64_t seed) {
+    AIPlayerMinimax<Board> playerX(PLAYER_X_CODE, PLAYER_X_MARK, depthLimit);
+    AIPlayerMinimax<Board> playerO(PLAYER_O_CODE, PLAYER_O_MARK, depthLimit);
+    for(const Board& board : randomPositions<Board>(count, seed)) {
+        AIPlayerMinimax<Board>& player = (playerToMove(board) == PLAYER_X_CODE) ? playerX : playerO;
+        for(bool useTable : {true, false}) {
+            player.useTable = useTable;
+            player.ordering.moveOrdering = 0;
+            std::pair<moveRCPair, int> unorderedInPlace = searchInPlace(player, board);
+            std::pair<moveRCPair, int> unorderedTree = searchTree(player, board);
+            player.ordering.moveOrdering = ORDER_ALL;
+            assert(searchInPlace(player, board) == unorderedInPlace);
+            assert(searchTree(player, board) == unorderedTree);
+        }
+    }
+}
+
+void test_moveOrdering() {
+    checkOrdering<TicTacToe>(40, 0, 4);
+    checkOrdering<Board4x4x3>(20, 2, 5);
+    checkOrdering<UltimateBoard>(10, 2, 6);
+
+    // Searching likely cutoffs first leaves fewer states to search
+    AIPlayerMinimax<TicTacToe> playerX(PLAYER_X_CODE, PLAYER_X_MARK, 0);
+    playerX.useTable = false;
+    playerX.ordering.moveOrdering = 0;
+    searchInPlace(playerX, TicTacToe());
+    int unordered = playerX.treeSize;
+    playerX.ordering.moveOrdering = ORDER_ALL;
+    searchInPlace(playerX, TicTacToe());
+    assert(playerX.treeSize < unordered);
+}
+
+/**
+ * Assert that a player set up by @param setUp returns the move and value of the serial alpha-beta search
+ * at @param count random positions of @param Board to @param depthLimit.
+ */
+template<class Board, class SetUp>
+void checkDriver(int count, int depthLimit, uint64_t seed, SetUp setUp) {
+    for(const Board& board : randomPositions<Board>(count, seed)) {
+        int code = playerToMove(board);
+        char mark = codeToMark(code);
+        AIPlayerMinimax<Board> serial(code, mark, depthLimit);
+        AIPlayerMinimax<Board> driver(code, mark, depthLimit);
+        setUp(driver);
+        std::pair<moveRCPair, int> reference = searchInPlace(serial, board);
+        std::pair<moveRCPair, int> result = searchInPlace(driver, board);
+        assert(result.second == reference.second);
+        assert(result.first == reference.first);
+    }
+}
+
+void test_parallelSearch() {
+    for(int threads : {2, 3, 4}) {
+        auto setUp = [threads](auto& player) { player.threads = threads; };
+        checkDriver<TicTacToe>(20, 0, 7, setUp);
+        checkDriver<Board4x4x3>(10, 2, 8, setUp);
+        checkDriver<Board5x5x4>(5, 2, 9, setUp);
+        checkDriver<UltimateBoard>(5, 2, 10, setUp);
+    }
+}
+
+void test_pvsSearch() {
+    auto setUp = [](auto& player) { player.searchMode = SEARCH_PVS; };
+    checkDriver<TicTacToe>(20, 0, 11, setUp);
+    checkDriver<Board4x4x3>(10, 2, 12, setUp);
+    checkDriver<Board5x5x4>(5, 2, 13, setUp);
+    checkDriver<UltimateBoard>(5, 2, 14, setUp);
+}
+
+/**
+ * Assert that MTD(f) returns the move and value of the serial alpha-beta search at @param count random positions of @param Board
+ * to @param depthLimit, from first guesses at, next to, and far from the value.  Returns the searches that found the move again.
+ */
+template<class Board>
+long checkMtdf(int count, int depthLimit, uint64_t seed) {
+    long researches = 0;
+    for(const Board& board : randomPositions<Board>(count, seed)) {
+        int code = playerToMove(board);
+        AIPlayerMinimax<Board> serial(code, codeToMark(code), depthLimit);
+        AIPlayerMinimax<Board> mtdf(code, codeToMark(code), depthLimit);
+        mtdf.searchMode = SEARCH_MTDF;
+        std::pair<moveRCPair, int> reference = searchInPlace(serial, board);
+        for(int guess : {reference.second, reference.second - 1, reference.second + 1, -1000, 1000}) {
+            mtdf.mtdfResearches = 0;
+            std::pair<moveRCPair, int> result = searchInPlace(mtdf, board, guess);
+            assert(result.second == reference.second);
+            assert(result.first == reference.first);
+            researches += mtdf.mtdfResearches;
+        }
+    }
+    return researches;
+}
+
+void test_mtdfSearch() {
+    long researches = checkMtdf<TicTacToe>(20, 0, 15) + checkMtdf<Board4x4x3>(10, 2, 16) + checkMtdf<Board5x5x4>(5, 2, 17);
+    // Guesses below the value fail high below it, so the first move of the value is searched for again
+    assert(researches > 0);
+}
+
+void test_batchLeaves() {
+    // Scoring the last layer in batches gives the same moves and values, on boards scored by the kernels and on those that are not
+    auto setUp = [](auto& player) { player.batchLeaves = true; };
+    checkDriver<TicTacToe>(20, 0, 18, setUp);
+    checkDriver<Board4x4x3>(10, 2, 19, setUp);
+    checkDriver<Board5x5x4>(5, 2, 20, setUp);
+    checkDriver<Board7x7x5>(3, 2, 21, setUp);
+    checkDriver<UltimateBoard>(5, 2, 22, setUp);
+}
+
+/**
+ * Returns the value of a fresh negamaxSearch() of @param depth layers at @param board, for the player of @param code to move.
+ */
+template<class Board>
+int searchValue(const Board& board, int code, int depth) {
+    AIPlayerMinimax<Board> player(code, codeToMark(code), 0);
+    Game<Board> game(board, code);
+    game.hashSymmetries(player.useSymmetry);
+    return player.negamaxSearch(game, depth, -1000, 1000, 1, std::make_pair(-1, -1)).second;
+}
+
+/**
+ * Returns the depth, up to @param maxDepth, of a fresh search at @param board that @param result could be the end of:
+ * the value is that search's, and the move reaches it.  Returns 0 if there is none.
+ */
+template<class Board>
+int completedDepth(const Board& board, int code, std::pair<moveRCPair, int> result, int maxDepth) {
+    Board next = board;
+    next.set(result.first.row, result.first.column, codeToMark(code));
+    for(int depth = 1; depth <= maxDepth; depth++) {
+        if(searchValue(board, code, depth) == result.second && -searchValue(next, -code, depth - 1) == result.second) return depth;
+    }
+    return 0;
+}
+
+void test_iterativeDeepening() {
+    // With time to spare, every iteration of the 3x3 game completes
+    AIPlayerMinimax<TicTacToe> patient(PLAYER_X_CODE, PLAYER_X_MARK, 0, 60000);
+    Game<TicTacToe> game(TicTacToe(), PLAYER_X_CODE);
+    std::pair<moveRCPair, int> result = patient.iterativeDeepeningSearch(game, patient.depthLimit * 2);
+    assert(!patient.timedOut);
+    assert(result.second == searchValue(TicTacToe(), PLAYER_X_CODE, TicTacToe::CELLS));
+    assert(completedDepth(TicTacToe(), PLAYER_X_CODE, result, TicTacToe::CELLS) > 0);
+
+    // A millisecond runs out long before the 81 layers of Ultimate Tic Tac Toe,
+    // so the move and value are those of the deepest iteration that completed
+    AIPlayerMinimax<UltimateBoard> hasty(PLAYER_X_CODE, PLAYER_X_MARK, 0, 1);
+    Game<UltimateBoard> ultimate(UltimateBoard(), PLAYER_X_CODE);
+    result = hasty.iterativeDeepeningSearch(ultimate, hasty.depthLimit * 2);
+    assert(hasty.timedOut);
+    assert(result.first == hasty.rootMove);
+    assert(getValidActions(UltimateBoard()).contains(result.first.row, result.first.column));
+    assert(completedDepth(UltimateBoard(), PLAYER_X_CODE, result, 8) > 0);
+    // The search takes back every move it made
+    assert(ultimate.turns == 0 && ultimate.board.state == UltimateBoard());
+}
+
+/**
+ * Assert that analyze() scores every valid move, best first, at @param count random positions of @param Board to @param depthLimit.
+ * Each score is that of a full search of the move by itself, each principal variation is a line of valid moves from it,
+ * and the first move and score are those of the search for the move to play.
+ */
+template<class Board>
+void checkAnalyze(int count, int depthLimit, uint64_t seed) {
+    for(const Board& board : randomPositions<Board>(count, seed)) {
+        int code = playerToMove(board);
+        AIPlayerMinimax<Board> player(code, codeToMark(code), depthLimit);
+        Game<Board> game(board, code);
+        std::vector<MoveAnalysis> analysis = player.analyze(&game);
+        typename Board::MoveSet validActions = getValidActions(board);
+        assert((int)analysis.size() == validActions.size());
+
+        for(size_t i = 0; i < analysis.size(); i++) {
+            const MoveAnalysis& entry = analysis[i];
+            assert(validActions.contains(entry.move.row, entry.move.column));
+            validActions.cells &= ~(typename Board::Mask(1) << Board::toCell(entry.move.row, entry.move.column));
+            if(i > 0) assert(analysis[i - 1].score >= entry.score);
+
+            Board next = board;
+            next.set(entry.move.row, entry.move.column, codeToMark(code));
+            assert(entry.score == -searchValue(next, -code, player.depthLimit * 2 - 1));
+
+            assert(!entry.pv.empty() && entry.pv.front() == entry.move);
+            Game<Board> line(board, code);
+            for(moveRCPair move : entry.pv) {
+                assert(line.result == ONGOING && getValidActions(line.board.state).contains(move.row, move.column));
+                line.makeMove(move.row, move.column);
+            }
+        }
+
+        AIPlayerMinimax<Board> reference(code, codeToMark(code), depthLimit);
+        std::pair<moveRCPair, int> best = searchInPlace(reference, board);
+        assert(analysis.front().move == best.first && analysis.front().score == best.second);
+        // The game is left as it was
+        assert(game.board.state == board && game.turns == 0);
+    }
+}
+
+void test_analyze() {
+    checkAnalyze<TicTacToe>(20, 0, 23);
+    checkAnalyze<Board4x4x3>(10, 2, 24);
+    checkAnalyze<Board5x5x4>(5, 2, 25);
+    checkAnalyze<UltimateBoard>(5, 2, 26);
+
+    // A finished game has nothing to analyze
+    TicTacToe won;
+    won.set(0, 0, PLAYER_X_MARK);
+    won.set(0, 1, PLAYER_X_MARK);
+    won.set(0, 2, PLAYER_X_MARK);
+    won.set(1, 0, PLAYER_O_MARK);
+    won.set(1, 1, PLAYER_O_MARK);
+    AIPlayerMinimax<TicTacToe> playerO(PLAYER_O_CODE, PLAYER_O_MARK, 0);
+    Game<TicTacToe> game(won, PLAYER_O_CODE);
+    assert(playerO.analyze(&game).empty());
+}
+
+int main(int argc, char** argv) {
+    test_negamaxSearch();
+    test_iterativeDeepening();
+    test_analyze();
+    test_moveOrdering();
+    test_parallelSearch();
+    test_pvsSearch();
+    test_mtdfSearch();
+    test_batchLeaves();
+
+    return 0;
+}
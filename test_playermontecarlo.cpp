@@ -9,156 +9,453 @@
 
 #include <iostream>
 #include <assert.h>
+#include <vector>
+
+// X can win in one at 0,2, and without 0,1, has to block O at 2,2 instead
+TicTacToe winInOne() {
+    TicTacToe bb;
+    bb.set(0, 0, PLAYER_X_MARK);
+    bb.set(0, 1, PLAYER_X_MARK);
+    bb.set(2, 0, PLAYER_O_MARK);
+    bb.set(2, 1, PLAYER_O_MARK);
+    return bb;
+}
 
 void test_createNode() {
-    char bb[3][3] = BLANK_BOARD;
-    MonteCarloTreeNode* a = createNode(SELF, bb, std::make_pair(-1, -1), NULL, 0);
-    assert(a->player == SELF);
-    for(int i = 0; i < 9; i++) {
-        assert(a->gameState[(int)(i / 3)][i % 3] == bb[(int)(i / 3)][i % 3]);
-    }
-    assert(a->action == std::make_pair(-1, -1));
-    assert(a->predecessor == NULL);
-    assert(a->successors.empty());
-    assert(a->untriedActions.size() == 9);
-
-    delete a;
+    TicTacToe bb;
+    MonteCarloTree<TicTacToe> tree;
+    uint32_t a = tree.createNode(SELF, bb, std::make_pair(-1, -1), NO_NODE);
+    assert(tree.root == a);
+    assert(tree[a].player == SELF);
+    assert(tree[a].gameState == bb);
+    assert(tree[a].action() == std::make_pair(-1, -1));
+    assert(tree[a].predecessor == NO_NODE);
+    assert(tree[a].numOfSuccessors == 0);
+    assert(tree[a].untriedActions.size() == 9);
 }
 
 void test_selection() {
-    AIPlayerMonteCarlo playerX = AIPlayerMonteCarlo(PLAYER_X_CODE, PLAYER_X_MARK, 1);
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 1);
 
-    char bb[3][3] = BLANK_BOARD;
-    MonteCarloTreeNode* a = createNode(SELF, bb, std::make_pair(-1, -1), NULL, 0);
-    MonteCarloTreeNode* b = createNode(OPPONENT, bb, std::make_pair(-1, -1), a, 1);
-    a->successors.push_back(b);
+    TicTacToe bb;
+    uint32_t a = playerX.tree.createNode(SELF, bb, std::make_pair(-1, -1), NO_NODE);
+    uint32_t b = playerX.tree.createNode(OPPONENT, bb, std::make_pair(-1, -1), a);
+    playerX.tree[a].successors = b;
+    playerX.tree[a].numOfSuccessors = 1;
     assert(playerX.selection(a, &ucb) == b);
-
-    delete a;
-    delete b;
 }
 
 void test_expansion() {
-    AIPlayerMonteCarlo playerX = AIPlayerMonteCarlo(PLAYER_X_CODE, PLAYER_X_MARK, 1);
-    AIPlayerMonteCarlo playerO = AIPlayerMonteCarlo(PLAYER_O_CODE, PLAYER_O_MARK, 1);
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 1);
+    AIPlayerMonteCarlo<TicTacToe> playerO = AIPlayerMonteCarlo<TicTacToe>(PLAYER_O_CODE, PLAYER_O_MARK, 1);
     
-    char bb[3][3] = BLANK_BOARD;
+    TicTacToe bb;
+
+    uint32_t a = playerX.tree.createNode(SELF, bb, std::make_pair(-1, -1), NO_NODE);
+
+    uint32_t b = playerX.expansion(a);
+    MonteCarloTree<TicTacToe>& tree = playerX.tree;
+    assert(tree[a].untriedActions.size() == 0);
+    // The corner, edge, and center moves stand for their symmetric moves
+    assert(tree[a].numOfSuccessors == 3);
+    // The successors are side by side
+    assert(b >= tree[a].successors && b < tree[a].successors + 3);
+    assert(tree[tree[a].successors].player != tree[a].player);
+    assert(tree[tree[a].successors].predecessor == a);
+    assert(tree[tree[a].successors].untriedActions.size() == 8);
+
+    // Scions keep the successors together
+    tree.createScion(tree[a].successors + 1);
+    assert(tree.size() == 1 && tree[tree.root].predecessor == NO_NODE);
+}
 
-    MonteCarloTreeNode* a = createNode(SELF, bb, std::make_pair(-1, -1), NULL, 0);
+void test_expansionSymmetry() {
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 1);
 
+    // Mirrored along the main diagonal only
+    char corner[3][3] = {PLAYER_X_MARK, CLEAR, CLEAR, CLEAR, CLEAR, CLEAR, CLEAR, CLEAR, CLEAR};
+    uint32_t a = playerX.tree.createNode(SELF, toBitBoard(corner), std::make_pair(-1, -1), NO_NODE);
     playerX.expansion(a);
-    std::cout << "A" << std::endl;
-    assert(a->untriedActions.size() == 0);
-    std::cout << "A" << std::endl;
-    assert(a->successors.size() == 9);
-    std::cout << "A" << std::endl;
-    assert(a->successors.front()->player != a->player);
-    std::cout << "A" << std::endl;
-    assert(a->successors.front()->predecessor == a);
-    std::cout << "A" << std::endl;
-    assert(a->successors.front()->untriedActions.size() == 8);
-    std::cout << "A" << std::endl;
-    delete a;
-    std::cout << "A" << std::endl;
+    assert(playerX.tree[a].numOfSuccessors == 5);
+    playerX.tree.clear();
+
+    playerX.useSymmetry = false;
+    uint32_t b = playerX.tree.createNode(SELF, toBitBoard(corner), std::make_pair(-1, -1), NO_NODE);
+    playerX.expansion(b);
+    assert(playerX.tree[b].numOfSuccessors == 8);
+    playerX.tree.clear();
+}
+
+void test_symmetry() {
+    char grid[3][3] = {PLAYER_X_MARK, PLAYER_O_MARK, CLEAR, CLEAR, CLEAR, CLEAR, CLEAR, CLEAR, PLAYER_X_MARK};
+    TicTacToe board = toBitBoard(grid);
+
+    for(int t = 0; t < TicTacToe::SYMMETRIES; t++) {
+        TicTacToe image = transformBoard(board, t);
+        assert(symmetryBetween(board, image) >= 0);
+        assert(transformBoard(image, SYMMETRY_TABLE<TicTacToe>.inverse[t]) == board);
+        assert(canonicalize(image).state == canonicalize(board).state);
+
+        // A move on the canonical board maps back to the same box
+        Canonical<TicTacToe> canonical = canonicalize(image);
+        assert(untransformMove<TicTacToe>(transformMove<TicTacToe>(std::make_pair(0, 1), canonical.symmetry), canonical.symmetry) == std::make_pair(0, 1));
+    }
+
+    // Moving the O breaks the symmetry
+    char other[3][3] = {PLAYER_X_MARK, CLEAR, CLEAR, CLEAR, PLAYER_O_MARK, CLEAR, CLEAR, CLEAR, PLAYER_X_MARK};
+    assert(symmetryBetween(board, toBitBoard(other)) == -1);
 }
 
 void test_isTerminalNode() {
-    char bb[3][3] = BLANK_BOARD;
-    MonteCarloTreeNode* a = createNode(SELF, bb, std::make_pair(-1, -1), NULL, 0);
-    assert(isTerminalNode(a) == false);
+    TicTacToe bb;
+    MonteCarloTree<TicTacToe> tree;
+    uint32_t a = tree.createNode(SELF, bb, std::make_pair(-1, -1), NO_NODE);
+    assert(isTerminalNode(tree[a]) == false);
 
     char fullBoard[3][3] = {'X', 'X', 'X', 'X', 'X', 'X', 'X', 'X', 'X'};
-    MonteCarloTreeNode* b = createNode(SELF, fullBoard, std::make_pair(-1, -1), NULL, 0);
-    assert(isTerminalNode(b) == true);
+    uint32_t b = tree.createNode(SELF, toBitBoard(fullBoard), std::make_pair(-1, -1), NO_NODE);
+    assert(isTerminalNode(tree[b]) == true);
 
     char partialBoard[3][3] = {'X', 'X', 'X', 'X', 'X', 'X', CLEAR, CLEAR, CLEAR};
-    MonteCarloTreeNode* c = createNode(SELF, partialBoard, std::make_pair(-1, -1), NULL, 0);
-    assert(isTerminalNode(c) == true);
-
-    delete a;
-    delete b;
-    delete c;
+    uint32_t c = tree.createNode(SELF, toBitBoard(partialBoard), std::make_pair(-1, -1), NO_NODE);
+    assert(isTerminalNode(tree[c]) == true);
 }
 
 void test_getNodeResult() {
-    AIPlayerMonteCarlo playerX = AIPlayerMonteCarlo(PLAYER_X_CODE, PLAYER_X_MARK, 1);
-    AIPlayerMonteCarlo playerO = AIPlayerMonteCarlo(PLAYER_O_CODE, PLAYER_O_MARK, 1);
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 1);
+    AIPlayerMonteCarlo<TicTacToe> playerO = AIPlayerMonteCarlo<TicTacToe>(PLAYER_O_CODE, PLAYER_O_MARK, 1);
+    MonteCarloTree<TicTacToe> tree;
 
     char win[3][3] = {PLAYER_X_MARK, PLAYER_X_MARK, PLAYER_X_MARK, PLAYER_X_MARK, PLAYER_X_MARK, PLAYER_X_MARK, PLAYER_X_MARK, PLAYER_X_MARK, PLAYER_X_MARK};
-    MonteCarloTreeNode* a = createNode(SELF, win, std::make_pair(-1, -1), NULL, 0);
-    assert(playerX.getNodeResult(a) == 1);
+    uint32_t a = tree.createNode(SELF, toBitBoard(win), std::make_pair(-1, -1), NO_NODE);
+    assert(playerX.getNodeResult(tree[a]) == 1);
 
     char loss[3][3] = {PLAYER_O_MARK, PLAYER_O_MARK, PLAYER_O_MARK, PLAYER_O_MARK, PLAYER_O_MARK, PLAYER_O_MARK, PLAYER_O_MARK, PLAYER_O_MARK, PLAYER_O_MARK};
-    MonteCarloTreeNode* b = createNode(SELF, loss, std::make_pair(-1, -1), NULL, 0);
-    assert(playerX.getNodeResult(b) == -1);
+    uint32_t b = tree.createNode(SELF, toBitBoard(loss), std::make_pair(-1, -1), NO_NODE);
+    assert(playerX.getNodeResult(tree[b]) == -1);
 
     char draw[3][3] = {PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_X_MARK};
-    MonteCarloTreeNode* c = createNode(SELF, draw, std::make_pair(-1, -1), NULL, 0);
-    assert(playerX.getNodeResult(c) == 0);
-
-    delete a;
-    delete b;
-    delete c;
+    uint32_t c = tree.createNode(SELF, toBitBoard(draw), std::make_pair(-1, -1), NO_NODE);
+    assert(playerX.getNodeResult(tree[c]) == 0);
 }
 
 void test_simulation() {
-    AIPlayerMonteCarlo playerX = AIPlayerMonteCarlo(PLAYER_X_CODE, PLAYER_X_MARK, 1);
-    AIPlayerMonteCarlo playerO = AIPlayerMonteCarlo(PLAYER_O_CODE, PLAYER_O_MARK, 1);
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 1);
+    AIPlayerMonteCarlo<TicTacToe> playerO = AIPlayerMonteCarlo<TicTacToe>(PLAYER_O_CODE, PLAYER_O_MARK, 1);
 
     char willWin[3][3] = {PLAYER_X_MARK, CLEAR, PLAYER_X_MARK, CLEAR, CLEAR, CLEAR, PLAYER_X_MARK, CLEAR, PLAYER_X_MARK};
-    MonteCarloTreeNode* a = createNode(OPPONENT, willWin, std::make_pair(-1, -1), NULL, 0);
+    uint32_t a = playerX.tree.createNode(OPPONENT, toBitBoard(willWin), std::make_pair(-1, -1), NO_NODE);
     assert(playerX.simulation(a, &lightPlayout) == 1);
 
     char willLose[3][3] = {PLAYER_O_MARK, CLEAR, PLAYER_O_MARK, CLEAR, CLEAR, CLEAR, PLAYER_O_MARK, CLEAR, PLAYER_O_MARK};
-    MonteCarloTreeNode* b = createNode(OPPONENT, willLose, std::make_pair(-1, -1), NULL, 0);
+    uint32_t b = playerX.tree.createNode(OPPONENT, toBitBoard(willLose), std::make_pair(-1, -1), NO_NODE);
     assert(playerX.simulation(b, &lightPlayout) == -1);
 
     char willDraw[3][3] = {PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_X_MARK, PLAYER_O_MARK, PLAYER_X_MARK, PLAYER_O_MARK, CLEAR, PLAYER_O_MARK};
-    MonteCarloTreeNode* c = createNode(OPPONENT, willDraw, std::make_pair(-1, -1), NULL, 0);
+    uint32_t c = playerX.tree.createNode(OPPONENT, toBitBoard(willDraw), std::make_pair(-1, -1), NO_NODE);
     assert(playerX.simulation(c, &lightPlayout) == 0);
-
-    delete a;
-    delete b;
-    delete c;
 }
 
 void test_backpropagation() {
-    char bb[3][3] = BLANK_BOARD;
-    MonteCarloTreeNode* a = createNode(OPPONENT, bb, std::make_pair(-1, -1), NULL, 0);
-    MonteCarloTreeNode* b = createNode(SELF, bb, std::make_pair(-1, -1), a, 1);
+    TicTacToe bb;
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 1);
+    uint32_t a = playerX.tree.createNode(OPPONENT, bb, std::make_pair(-1, -1), NO_NODE);
+    uint32_t b = playerX.tree.createNode(SELF, bb, std::make_pair(-1, -1), a);
 
-    AIPlayerMonteCarlo playerX = AIPlayerMonteCarlo(PLAYER_X_CODE, PLAYER_X_MARK, 1);
-    b->minSimMovesToWin = 5;
+    playerX.tree[b].minSimMovesToWin = 5;
     playerX.backpropagation(b, 1);
-    assert(b->numOfVisits == 1);
-    assert(b->numOfWins == 1);
-    assert(a->numOfVisits == 1);
-    assert(a->numOfWins == 1);
-    assert(a->minSimMovesToWin == 5);
-
-    delete a;
-    delete b;
+    assert(playerX.tree[b].numOfVisits == 1);
+    assert(playerX.tree[b].numOfWins == 1);
+    assert(playerX.tree[a].numOfVisits == 1);
+    assert(playerX.tree[a].numOfWins == 1);
+    assert(playerX.tree[a].minSimMovesToWin == 5);
+
+    // A batch of playouts is counted in one pass
+    PlayoutResults results;
+    results.add(WIN, 3);
+    results.add(LOSS);
+    results.add(0);
+    playerX.backpropagation(b, results);
+    assert(playerX.tree[a].numOfVisits == 4);
+    assert(playerX.tree[a].numOfWins == 2);
+    assert(playerX.tree[a].numOfLosses == 1);
+    assert(playerX.tree[a].numOfDraws == 1);
+    assert(playerX.tree[a].minSimMovesToWin == 3);
 }
 
 void test_chooseMove() {
-    AIPlayerMonteCarlo playerX = AIPlayerMonteCarlo(PLAYER_X_CODE, PLAYER_X_MARK, 100);
-    AIPlayerMonteCarlo playerO = AIPlayerMonteCarlo(PLAYER_O_CODE, PLAYER_O_MARK, 1);
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 100);
+    AIPlayerMonteCarlo<TicTacToe> playerO = AIPlayerMonteCarlo<TicTacToe>(PLAYER_O_CODE, PLAYER_O_MARK, 1);
 
-    Game game;
+    Game<TicTacToe> game;
 
     moveRCPair move = playerX.chooseMove(&game);
     std::cout << move.row << " " << move.column << std::endl;
 }
 
+void test_chooseForcedMove() {
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 1);
+
+    // X wins in one at 0,2 rather than blocking O at 2,2
+    TicTacToe bb = winInOne();
+    Game<TicTacToe> game(bb, PLAYER_X_CODE);
+    assert(forcedMove(bb, PLAYER_X_MARK, PLAYER_O_MARK).kind == THREAT_WIN);
+    assert(playerX.chooseMove(&game) == std::make_pair(0, 2));
+
+    // X blocks O at 2,2
+    bb.clear(0, 1);
+    game.setState(bb, PLAYER_X_CODE);
+    assert(forcedMove(bb, PLAYER_X_MARK, PLAYER_O_MARK).kind == THREAT_BLOCK);
+    assert(playerX.chooseMove(&game) == std::make_pair(2, 2));
+
+    // X forks the diagonal and the middle column with 1,1
+    TicTacToe fork;
+    fork.set(0, 0, PLAYER_X_MARK);
+    fork.set(0, 1, PLAYER_X_MARK);
+    fork.set(0, 2, PLAYER_O_MARK);
+    fork.set(1, 0, PLAYER_O_MARK);
+    game.setState(fork, PLAYER_X_CODE);
+    assert(forcedMove(fork, PLAYER_X_MARK, PLAYER_O_MARK).kind == THREAT_FORK);
+    assert(playerX.chooseMove(&game) == std::make_pair(1, 1));
+}
+
+void test_analyze() {
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 200);
+
+    // Every move is listed once, best first, even the ones sharing a node by symmetry
+    Game<TicTacToe> game;
+    std::vector<MoveAnalysis> analysis = playerX.analyze(&game);
+    assert(analysis.size() == 9);
+    TicTacToe::Mask seen = 0;
+    for(int i = 0; i < (int)analysis.size(); i++) {
+        assert(analysis[i].pv.front() == analysis[i].move);
+        assert(i == 0 || analysis[i - 1].score >= analysis[i].score);
+        seen |= TicTacToe::Mask(1) << TicTacToe::toCell(analysis[i].move.row, analysis[i].move.column);
+    }
+    assert(seen == TicTacToe::FULL);
+    // The root stays, so the analysis is searched on
+    assert(playerX.tree[playerX.tree.root].numOfVisits == 200);
+}
+
+void test_seed() {
+    AIPlayerMonteCarlo<Board4x4x3> first = AIPlayerMonteCarlo<Board4x4x3>(PLAYER_X_CODE, PLAYER_X_MARK, 300);
+    AIPlayerMonteCarlo<Board4x4x3> second = AIPlayerMonteCarlo<Board4x4x3>(PLAYER_X_CODE, PLAYER_X_MARK, 300);
+    first.useThreats = second.useThreats = false;
+
+    // Players with the same seed search the same tree
+    first.random.seed(42);
+    second.random.seed(42);
+    Game<Board4x4x3> game(Board4x4x3(), PLAYER_X_CODE);
+    std::vector<MoveAnalysis> a = first.analyze(&game);
+    std::vector<MoveAnalysis> b = second.analyze(&game);
+    assert(a.size() == b.size());
+    for(int i = 0; i < (int)a.size(); i++) assert(a[i].move == b[i].move && a[i].score == b[i].score && a[i].pv == b[i].pv);
+
+    // Playouts of one seed do not repeat
+    Xoshiro256 random(7);
+    moveRCPair move = lightPlayout(PLAYER_X_MARK, Board4x4x3(), random);
+    bool varied = false;
+    for(int i = 0; i < 16 && !varied; i++) varied = lightPlayout(PLAYER_X_MARK, Board4x4x3(), random) != move;
+    assert(varied);
+}
+
+void test_rootParallel() {
+    AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 300);
+    playerX.threads = 3;
+    playerX.useThreats = false;
+
+    // Every tree is searched, and the move with the best results over all of them wins in one at 0,2
+    Game<TicTacToe> game(winInOne(), PLAYER_X_CODE);
+    playerX.search(&game);
+    const MonteCarloTreeNode<TicTacToe>& root = playerX.tree[playerX.tree.root];
+    assert(root.numOfVisits == 300);
+    // Each helper runs every iteration on its own tree
+    assert(playerX.numOfHelpers() == 2);
+    int visits = root.numOfVisits;
+    for(int h = 0; h < playerX.numOfHelpers(); h++) {
+        const MonteCarloTree<TicTacToe>& tree = playerX.helperTree(h);
+        const MonteCarloTreeNode<TicTacToe>& helperRoot = tree[tree.root];
+        assert(helperRoot.gameState == root.gameState);
+        assert(helperRoot.numOfVisits == 300);
+        assert(helperRoot.numOfWins + helperRoot.numOfDraws + helperRoot.numOfLosses == 300);
+        visits += helperRoot.numOfVisits;
+    }
+    assert(visits == 3 * 300);
+    // The merged moves add up the visits of every tree, and their results every visit
+    int merged = 0;
+    for(uint32_t s = root.successors; s < root.successors + root.numOfSuccessors; s++) {
+        MonteCarloTreeNode<TicTacToe> move = playerX.mergedSuccessor(s);
+        assert(move.numOfVisits >= playerX.tree[s].numOfVisits);
+        assert(move.numOfWins + move.numOfDraws + move.numOfLosses == move.numOfVisits);
+        merged += move.numOfVisits;
+    }
+    assert(merged == 3 * 300);
+    assert(playerX.chooseMove(&game) == std::make_pair(0, 2));
+}
+
+/**
+ * Assert that each node of @param tree below @param node counts one visit per result, so no virtual loss is left in it,
+ * and that only expanded nodes and terminal leaves are claimed.  Returns the number of nodes.
+ */
+template<class Board>
+int checkVisits(const MonteCarloTree<Board>& tree, uint32_t node) {
+    const MonteCarloTreeNode<Board>& current = tree[node];
+    assert(current.numOfVisits == current.numOfWins + current.numOfDraws + current.numOfLosses);
+    if(current.numOfSuccessors > 0) assert(current.claimed);
+    else if(current.claimed) assert(current.untriedActions.empty());
+    int nodes = 1;
+    for(uint32_t s = current.successors; s < current.successors + current.numOfSuccessors; s++) nodes += checkVisits(tree, s);
+    return nodes;
+}
+
+void test_sharedTree() {
+    for(int virtualLoss : {1, 3}) {
+        AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 300);
+        playerX.threads = 3;
+        playerX.parallelMode = PARALLEL_TREE;
+        playerX.virtualLoss = virtualLoss;
+        playerX.useThreats = false;
+
+        // Every thread adds to one tree, and no virtual loss is left in it once they are done
+        Game<TicTacToe> game(winInOne(), PLAYER_X_CODE);
+        playerX.search(&game);
+        const MonteCarloTreeNode<TicTacToe>& root = playerX.tree[playerX.tree.root];
+        assert(root.numOfVisits == 3 * 300);
+        assert(checkVisits(playerX.tree, playerX.tree.root) == (int)playerX.tree.size());
+        int successors = 0;
+        for(uint32_t s = root.successors; s < root.successors + root.numOfSuccessors; s++) successors += playerX.tree[s].numOfVisits;
+        // Only a thread that found the root claimed by another plays out from the root itself
+        assert(successors <= 3 * 300 && successors >= 3 * 300 - 3);
+        assert(playerX.chooseMove(&game) == std::make_pair(0, 2));
+    }
+}
+
+/**
+ * Returns the number of leaves played out from below @param node of @param tree, from the visits of each node
+ * that its successors do not have.  Asserts that each leaf was played out @param playouts times.
+ */
+template<class Board>
+int countLeaves(const MonteCarloTree<Board>& tree, uint32_t node, int playouts) {
+    const MonteCarloTreeNode<Board>& current = tree[node];
+    int own = current.numOfVisits;
+    int leaves = 0;
+    for(uint32_t s = current.successors; s < current.successors + current.numOfSuccessors; s++) {
+        own -= tree[s].numOfVisits;
+        leaves += countLeaves(tree, s, playouts);
+    }
+    assert(own >= 0 && own % playouts == 0);
+    return leaves + own / playouts;
+}
+
+void test_leafParallel() {
+    // Batches on this thread alone, and shared by 3 threads that do not split 7 playouts evenly
+    for(int threads : {1, 3}) {
+        AIPlayerMonteCarlo<TicTacToe> playerX = AIPlayerMonteCarlo<TicTacToe>(PLAYER_X_CODE, PLAYER_X_MARK, 100);
+        playerX.threads = threads;
+        playerX.parallelMode = PARALLEL_LEAF;
+        playerX.leafPlayouts = 7;
+        playerX.useThreats = false;
+
+        // Every playout of each leaf counts, from whichever thread played it, so there are as many playouts as leaves times the batch
+        Game<TicTacToe> game(winInOne(), PLAYER_X_CODE);
+        playerX.search(&game);
+        const MonteCarloTreeNode<TicTacToe>& root = playerX.tree[playerX.tree.root];
+        assert(root.numOfVisits == 100 * 7);
+        assert(checkVisits(playerX.tree, playerX.tree.root) == (int)playerX.tree.size());
+        assert(countLeaves(playerX.tree, playerX.tree.root, 7) == 100);
+        int successors = 0;
+        for(uint32_t s = root.successors; s < root.successors + root.numOfSuccessors; s++) successors += playerX.tree[s].numOfVisits;
+        // The root is expanded by the first iteration, so every playout is below it
+        assert(successors == 100 * 7);
+        assert(playerX.chooseMove(&game) == std::make_pair(0, 2));
+    }
+}
+
+/**
+ * Returns the number of nodes of @param tree in the subtree of @param index.
+ */
+template<class Board>
+size_t subtreeSize(const MonteCarloTree<Board>& tree, uint32_t index) {
+    size_t size = 1;
+    for(uint32_t s = tree[index].successors; s < tree[index].successors + tree[index].numOfSuccessors; s++) size += subtreeSize(tree, s);
+    return size;
+}
+
+/**
+ * Assert that the successors of every node of @param tree lie side by side after it and point back to it,
+ * and that the root has no predecessor.  Returns the number of nodes reached from the root.
+ */
+template<class Board>
+size_t checkLayout(const MonteCarloTree<Board>& tree) {
+    assert(tree[tree.root].predecessor == NO_NODE);
+    std::vector<uint32_t> stack = {tree.root};
+    size_t reached = 0;
+    while(!stack.empty()) {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        reached++;
+        const MonteCarloTreeNode<Board>& node = tree[index];
+        if(node.numOfSuccessors == 0) continue;
+
+        assert(node.successors != NO_NODE && node.successors > index);
+        for(uint32_t s = node.successors; s < node.successors + node.numOfSuccessors; s++) {
+            assert(tree[s].predecessor == index);
+            assert(tree[s].player != node.player);
+            stack.push_back(s);
+        }
+    }
+    return reached;
+}
+
+/**
+ * Assert that a search of @param Board leaves every node in the layout of checkLayout(),
+ * and that a scion of the most visited successor keeps that subtree whole in the same layout.
+ */
+template<class Board>
+void checkTree(int iterations) {
+    AIPlayerMonteCarlo<Board> playerX(PLAYER_X_CODE, PLAYER_X_MARK, iterations);
+    Game<Board> game(Board(), PLAYER_X_CODE);
+    playerX.search(&game);
+    MonteCarloTree<Board>& tree = playerX.tree;
+    assert(checkLayout(tree) == tree.size());
+
+    const MonteCarloTreeNode<Board>& root = tree[tree.root];
+    uint32_t keep = root.successors;
+    for(uint32_t s = root.successors; s < root.successors + root.numOfSuccessors; s++) {
+        if(tree[s].numOfVisits > tree[keep].numOfVisits) keep = s;
+    }
+    MonteCarloTreeNode<Board> kept = tree[keep];
+    size_t size = subtreeSize(tree, keep);
+    tree.createScion(keep);
+    assert(tree.size() == size && checkLayout(tree) == size);
+    assert(tree[tree.root].gameState == kept.gameState && tree[tree.root].numOfVisits == kept.numOfVisits);
+    assert(tree[tree.root].numOfWins == kept.numOfWins && tree[tree.root].numOfSuccessors == kept.numOfSuccessors);
+}
+
+void test_treeLayout() {
+    checkTree<TicTacToe>(2000);
+    checkTree<Board5x5x4>(2000);
+    checkTree<UltimateBoard>(2000);
+}
+
 int main(int argc, char** argv) {
     test_createNode();
     test_selection();
     test_expansion();
+    test_expansionSymmetry();
+    test_symmetry();
     test_isTerminalNode();
     test_getNodeResult();
     test_simulation();
     test_backpropagation();
     test_chooseMove();
+    test_chooseForcedMove();
+    test_analyze();
+    test_seed();
+    test_rootParallel();
+    test_sharedTree();
+    test_leafParallel();
+    test_treeLayout();
 
     return 0;
 }
@@ -0,0 +1,107 @@
+/**
+ * @file test_playerproofnumber.cpp
+ * @author Vincent Li
+ * Test functionalities of playerproofnumber.cpp.
+ */
+
+#include "playerproofnumber.h"
+
+
+#include <iostream>
+#include <assert.h>
+
+// The position of the Monte Carlo tests: X can win at 0,2, and O at 2,2
+TicTacToe winInOne() {
+    TicTacToe bb;
+    bb.set(0, 0, PLAYER_X_MARK);
+    bb.set(0, 1, PLAYER_X_MARK);
+    bb.set(2, 0, PLAYER_O_MARK);
+    bb.set(2, 1, PLAYER_O_MARK);
+    return bb;
+}
+
+void test_chooseWin() {
+    TicTacToe bb = winInOne();
+    AIPlayerProofNumber<TicTacToe> playerX(PLAYER_X_CODE, PLAYER_X_MARK);
+    Game<TicTacToe> game(bb, PLAYER_X_CODE);
+    assert(playerX.chooseMove(&game) == std::make_pair(0, 2));
+    assert(playerX.proven == PROVEN_WIN);
+
+    // O to move wins at 2,2 instead
+    AIPlayerProofNumber<TicTacToe> playerO(PLAYER_O_CODE, PLAYER_O_MARK);
+    game.setState(bb, PLAYER_O_CODE);
+    assert(playerO.chooseMove(&game) == std::make_pair(2, 2));
+    assert(playerO.proven == PROVEN_WIN);
+}
+
+void test_chooseBlock() {
+    // X blocks O at 0,1, the only move that holds the draw
+    TicTacToe bb;
+    bb.set(0, 0, PLAYER_X_MARK);
+    bb.set(1, 1, PLAYER_O_MARK);
+    bb.set(2, 1, PLAYER_O_MARK);
+    AIPlayerProofNumber<TicTacToe> playerX(PLAYER_X_CODE, PLAYER_X_MARK);
+    Game<TicTacToe> game(bb, PLAYER_X_CODE);
+    assert(playerX.chooseMove(&game) == std::make_pair(0, 1));
+    assert(playerX.proven == PROVEN_DRAW);
+
+    // The empty board is a draw
+    game.setState(TicTacToe(), PLAYER_X_CODE);
+    playerX.chooseMove(&game);
+    assert(playerX.proven == PROVEN_DRAW);
+}
+
+void test_chooseLoss() {
+    // Without 0,1, blocking O at 2,2 leaves O a fork at 1,1, so the Monte Carlo tests' block is lost
+    TicTacToe bb = winInOne();
+    bb.clear(0, 1);
+    AIPlayerProofNumber<TicTacToe> playerX(PLAYER_X_CODE, PLAYER_X_MARK);
+    Game<TicTacToe> game(bb, PLAYER_X_CODE);
+    moveRCPair move = playerX.chooseMove(&game);
+    assert(playerX.proven == PROVEN_LOSS);
+    assert(bb.get(move.row, move.column) == CLEAR);
+
+    // X has three wins in one, so O loses after any move
+    TicTacToe fork;
+    fork.set(0, 0, PLAYER_X_MARK);
+    fork.set(0, 2, PLAYER_X_MARK);
+    fork.set(2, 0, PLAYER_X_MARK);
+    fork.set(2, 2, PLAYER_O_MARK);
+    fork.set(1, 2, PLAYER_O_MARK);
+    AIPlayerProofNumber<TicTacToe> playerO(PLAYER_O_CODE, PLAYER_O_MARK);
+    game.setState(fork, PLAYER_O_CODE);
+    playerO.chooseMove(&game);
+    assert(playerO.proven == PROVEN_LOSS);
+}
+
+void test_largerBoard() {
+    // The first player wins 3 in a row on a 4x4 board, and the winning move keeps the win
+    AIPlayerProofNumber<Board4x4x3> playerX(PLAYER_X_CODE, PLAYER_X_MARK);
+    Game<Board4x4x3> game(Board4x4x3(), PLAYER_X_CODE);
+    moveRCPair move = playerX.chooseMove(&game);
+    assert(playerX.proven == PROVEN_WIN);
+    game.makeMove(move.row, move.column);
+    AIPlayerProofNumber<Board4x4x3> playerO(PLAYER_O_CODE, PLAYER_O_MARK);
+    playerO.chooseMove(&game);
+    assert(playerO.proven == PROVEN_LOSS);
+}
+
+void test_nodeLimit() {
+    // The empty board is not solved within a few nodes, but a valid move is still played
+    AIPlayerProofNumber<TicTacToe> playerX(PLAYER_X_CODE, PLAYER_X_MARK, 5);
+    Game<TicTacToe> game(TicTacToe(), PLAYER_X_CODE);
+    moveRCPair move = playerX.chooseMove(&game);
+    assert(playerX.proven == PROVEN_UNKNOWN);
+    assert(move.row >= 0 && move.row < 3 && move.column >= 0 && move.column < 3);
+    assert(playerX.tree.empty());
+}
+
+int main(int argc, char** argv) {
+    test_chooseWin();
+    test_chooseBlock();
+    test_chooseLoss();
+    test_largerBoard();
+    test_nodeLimit();
+
+    return 0;
+}
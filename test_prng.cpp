@@ -0,0 +1,72 @@
+/**
+ * @file test_prng.cpp
+ * @author Vincent Li
+ * Test the generators of prng.h.
+ */
+
+#include "prng.h"
+
+
+#include <iostream>
+#include <assert.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+void test_seed() {
+    // A seed gives the same sequence every time, and another seed a different one
+    Xoshiro256 a(42);
+    Xoshiro256 b(42);
+    Xoshiro256 c(43);
+    bool differs = false;
+    for(int i = 0; i < 100; i++) {
+        uint64_t x = a.next();
+        assert(x == b.next());
+        differs |= (x != c.next());
+    }
+    assert(differs);
+
+    // Seeding again restarts the sequence, and a seed of 0 still fills the state
+    a.seed(42);
+    b.seed(42);
+    assert(a.next() == b.next());
+    Xoshiro256 zero(0);
+    assert(zero.next() != zero.next());
+}
+
+void test_below() {
+    // Every number below n comes up, and none past it
+    Xoshiro256 random(7);
+    int counts[6] = {};
+    for(int i = 0; i < 6000; i++) {
+        uint32_t x = random.below(6);
+        assert(x < 6);
+        counts[x]++;
+    }
+    for(int count : counts) assert(count > 800 && count < 1200);
+    assert(random.below(1) == 0);
+}
+
+void test_clockSeed() {
+    // Threads that seed at the same time still get different seeds
+    const int threads = 4;
+    const int calls = 1000;
+    std::vector<uint64_t> seeds(threads * calls);
+    std::vector<std::thread> workers;
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&seeds, t]() {
+            for(int i = 0; i < calls; i++) seeds[t * calls + i] = clockSeed();
+        });
+    }
+    for(std::thread& worker : workers) worker.join();
+    std::sort(seeds.begin(), seeds.end());
+    assert(std::adjacent_find(seeds.begin(), seeds.end()) == seeds.end());
+}
+
+int main(int argc, char** argv) {
+    test_seed();
+    test_below();
+    test_clockSeed();
+
+    return 0;
+}
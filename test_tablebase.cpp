@@ -0,0 +1,155 @@
+/**
+ * @file test_tablebase.cpp
+ * @author Vincent Li
+ * Test functionalities of tablebase.cpp and playertablebase.cpp.
+ */
+
+#include "tablebase.h"
+#include "playertablebase.h"
+
+
+#include <stdio.h>
+#include <iostream>
+#include <assert.h>
+
+// Returns the entry of the given board with the player of the given code to move
+const TablebaseEntry& entryOf(const std::vector<TablebaseEntry>& entries, const TicTacToe& board, int currentPlayer) {
+    return entries[tablebaseIndex(board, currentPlayer)];
+}
+
+void test_reachablePositions() {
+    std::vector<TablebaseEntry> entries = createTablebase();
+    assert((int)entries.size() == TABLEBASE_ENTRIES);
+
+    // A position is reached with Player X first if X has as many marks as O with X to move, or one more with O to move
+    int xFirst = 0;
+    int oFirst = 0;
+    for(int index = 0; index < TERNARY_BOARDS; index++) {
+        int xMarks = 0;
+        int oMarks = 0;
+        for(int digits = index; digits > 0; digits /= 3) {
+            xMarks += (digits % 3 == 1);
+            oMarks += (digits % 3 == 2);
+        }
+        bool xToMove = entries[index].distance != UNREACHABLE;
+        bool oToMove = entries[TERNARY_BOARDS + index].distance != UNREACHABLE;
+        xFirst += (xToMove && xMarks == oMarks) + (oToMove && xMarks == oMarks + 1);
+        oFirst += (oToMove && xMarks == oMarks) + (xToMove && oMarks == xMarks + 1);
+    }
+    assert(xFirst == 5478);
+    assert(oFirst == 5478);
+}
+
+void test_values() {
+    std::vector<TablebaseEntry> entries = createTablebase();
+
+    // The empty board is a draw that fills the board, and every first move keeps it
+    TicTacToe bb;
+    const TablebaseEntry& empty = entryOf(entries, bb, PLAYER_X_CODE);
+    assert(empty.value == DRAW);
+    assert(empty.distance == 9);
+    assert(empty.bestMoves == TicTacToe::FULL);
+
+    // X wins in one at 0,2 rather than blocking O at 2,2, and O to move would win at 2,2 instead
+    bb.set(0, 0, PLAYER_X_MARK);
+    bb.set(0, 1, PLAYER_X_MARK);
+    bb.set(2, 0, PLAYER_O_MARK);
+    bb.set(2, 1, PLAYER_O_MARK);
+    const TablebaseEntry& xWins = entryOf(entries, bb, PLAYER_X_CODE);
+    assert(xWins.value == WIN);
+    assert(xWins.distance == 1);
+    assert(xWins.bestMoves == 1 << TicTacToe::toCell(0, 2));
+    const TablebaseEntry& oWins = entryOf(entries, bb, PLAYER_O_CODE);
+    assert(oWins.value == WIN);
+    assert(oWins.bestMoves == 1 << TicTacToe::toCell(2, 2));
+
+    // X has three wins in one, so O loses after any move
+    TicTacToe fork;
+    fork.set(0, 0, PLAYER_X_MARK);
+    fork.set(0, 2, PLAYER_X_MARK);
+    fork.set(2, 0, PLAYER_X_MARK);
+    fork.set(2, 2, PLAYER_O_MARK);
+    fork.set(1, 2, PLAYER_O_MARK);
+    const TablebaseEntry& lost = entryOf(entries, fork, PLAYER_O_CODE);
+    assert(lost.value == LOSS);
+    assert(lost.distance == 2);
+
+    // A finished game has no moves
+    fork.set(1, 1, PLAYER_O_MARK);
+    fork.set(0, 1, PLAYER_X_MARK);
+    const TablebaseEntry& over = entryOf(entries, fork, PLAYER_O_CODE);
+    assert(over.value == LOSS && over.distance == 0 && over.bestMoves == 0);
+}
+
+void test_file() {
+    std::vector<TablebaseEntry> entries = createTablebase();
+    const char* path = "test_tablebase.tb";
+    assert(writeTablebase(path, entries));
+
+    Tablebase tablebase;
+    assert(tablebase.open(path));
+    assert(tablebase.isOpen());
+    for(int index = 0; index < TERNARY_BOARDS; index++) {
+        if(entries[index].distance == UNREACHABLE) continue;
+        // Every mapped entry is the one written
+        TicTacToe board;
+        int digits = index;
+        for(int cell = 0; cell < TicTacToe::CELLS; cell++, digits /= 3) {
+            if(digits % 3 == 1) board.set(cell / 3, cell % 3, PLAYER_X_MARK);
+            else if(digits % 3 == 2) board.set(cell / 3, cell % 3, PLAYER_O_MARK);
+        }
+        const TablebaseEntry* entry = tablebase.lookup(board, PLAYER_X_CODE);
+        assert(entry != NULL);
+        assert(entry->value == entries[index].value && entry->distance == entries[index].distance);
+        assert(entry->bestMoves == entries[index].bestMoves);
+        if(entry->bestMoves != 0) {
+            moveRCPair move = Tablebase::pickMove(entry);
+            assert(entry->bestMoves & (1 << TicTacToe::toCell(move.row, move.column)));
+        }
+    }
+
+    // Unreachable positions are not found: X can not have two more marks than O
+    TicTacToe unreachable;
+    unreachable.set(0, 0, PLAYER_X_MARK);
+    unreachable.set(0, 1, PLAYER_X_MARK);
+    assert(tablebase.lookup(unreachable, PLAYER_O_CODE) == NULL);
+
+    // Files that are not tablebases are not mapped
+    Tablebase missing;
+    assert(!missing.open("no_such_file.tb"));
+    assert(!missing.isOpen());
+
+    remove(path);
+}
+
+void test_chooseMove() {
+    const char* path = "test_tablebase.tb";
+    assert(writeTablebase(path, createTablebase()));
+    AIPlayerTablebase playerX(PLAYER_X_CODE, PLAYER_X_MARK, path);
+    assert(playerX.tablebase.isOpen());
+
+    // X wins in one at 0,2 rather than blocking O at 2,2
+    TicTacToe bb;
+    bb.set(0, 0, PLAYER_X_MARK);
+    bb.set(0, 1, PLAYER_X_MARK);
+    bb.set(2, 0, PLAYER_O_MARK);
+    bb.set(2, 1, PLAYER_O_MARK);
+    Game<TicTacToe> game(bb, PLAYER_X_CODE);
+    assert(playerX.chooseMove(&game) == std::make_pair(0, 2));
+
+    // X blocks O at 2,2
+    bb.clear(0, 1);
+    game.setState(bb, PLAYER_X_CODE);
+    assert(playerX.chooseMove(&game) == std::make_pair(2, 2));
+
+    remove(path);
+}
+
+int main(int argc, char** argv) {
+    test_reachablePositions();
+    test_values();
+    test_file();
+    test_chooseMove();
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file test_transposition.cpp
+ * @author Vincent Li
+ * Test functionalities of transposition.cpp.
+ */
+
+#include "transposition.h"
+
+
+#include <iostream>
+#include <assert.h>
+#include <thread>
+#include <vector>
+
+void test_storeProbe() {
+    TranspositionTable table(4);
+    TableEntry entry;
+    assert(!table.probe(5, entry));
+
+    table.store(5, -7, 3, LOWER_BOUND, std::make_pair(1, 2));
+    assert(table.probe(5, entry));
+    assert(entry.key == 5 && entry.value == -7 && entry.depth == 3 && entry.bound == LOWER_BOUND);
+    assert(entry.moveRow == 1 && entry.moveCol == 2);
+
+    // Every field survives packing, including the extremes of values and no move
+    table.store(6, -1000, 0, UPPER_BOUND, std::make_pair(-1, -1));
+    assert(table.probe(6, entry));
+    assert(entry.value == -1000 && entry.depth == 0 && entry.bound == UPPER_BOUND);
+    assert(entry.moveRow == -1 && entry.moveCol == -1);
+    table.store(7, 1000, 81, EXACT_BOUND, std::make_pair(8, 8));
+    assert(table.probe(7, entry));
+    assert(entry.value == 1000 && entry.depth == 81 && entry.bound == EXACT_BOUND);
+    assert(entry.moveRow == 8 && entry.moveCol == 8);
+}
+
+void test_keyCheck() {
+    // 5 and 21 share slot 5 of 16, and the full key tells them apart
+    TranspositionTable table(4);
+    TableEntry entry;
+    table.store(5, 10, 2, EXACT_BOUND, std::make_pair(0, 0));
+    assert(!table.probe(21, entry));
+
+    // Storing 21 replaces 5
+    table.store(21, 20, 1, UPPER_BOUND, std::make_pair(2, 2));
+    assert(!table.probe(5, entry));
+    assert(table.probe(21, entry) && entry.value == 20);
+
+    // An empty slot does not match the key 0, whose check it passes
+    assert(!table.probe(0, entry) && !table.probe(16, entry));
+}
+
+void test_clear() {
+    TranspositionTable table(4);
+    TableEntry entry;
+    table.store(3, 1, 1, EXACT_BOUND, std::make_pair(0, 1));
+    assert(table.probe(3, entry));
+    table.clear();
+    assert(!table.probe(3, entry));
+}
+
+// Returns the value stored with @param key in test_concurrentStores(), so each key has its own entry
+int valueOf(uint64_t key) {
+    return (int)(key * 37 % 2000) - 1000;
+}
+
+void test_concurrentStores() {
+    // Threads store different entries of 8 keys in the one slot of even keys, while another probes them.
+    // A slot torn between two stores fails the check, so every entry probed is one that was stored whole under its key.
+    TranspositionTable table(1);
+    std::vector<std::thread> writers;
+    for(int t = 0; t < 3; t++) {
+        writers.emplace_back([&table, t]() {
+            for(int i = 0; i < 200000; i++) {
+                uint64_t key = 2 + 2 * ((i + t) % 8);
+                table.store(key, valueOf(key), (int)(key % 50), (uint8_t)(key % 3), std::make_pair((int)key % 9, (int)key % 7));
+            }
+        });
+    }
+    for(int i = 0; i < 200000; i++) {
+        uint64_t key = 2 + 2 * (i % 8);
+        TableEntry entry;
+        if(!table.probe(key, entry)) continue;
+        assert(entry.key == key && entry.value == valueOf(key) && entry.depth == (int)(key % 50) && entry.bound == key % 3);
+        assert(entry.moveRow == (int)key % 9 && entry.moveCol == (int)key % 7);
+    }
+    for(std::thread& writer : writers) writer.join();
+
+    // After the last store, exactly one of the keys is in the slot
+    int stored = 0;
+    for(uint64_t key = 2; key <= 16; key += 2) {
+        TableEntry entry;
+        stored += table.probe(key, entry);
+    }
+    assert(stored == 1);
+}
+
+int main(int argc, char** argv) {
+    test_storeProbe();
+    test_keyCheck();
+    test_clear();
+    test_concurrentStores();
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file test_ultimate.cpp
+ * @author Vincent Li
+ * Test functionalities of ultimate.cpp and the rules of ultimate.h.
+ */
+
+#include "ultimate.h"
+#include "player.h"
+
+
+#include <iostream>
+#include <assert.h>
+#include <vector>
+
+void test_cells() {
+    // Sub-board s holds bits 9s to 9s + 8, in the order of a TicTacToe board
+    for(int row = 0; row < 9; row++) {
+        for(int col = 0; col < 9; col++) {
+            int cell = UltimateBoard::toCell(row, col);
+            assert(cell / 9 == (row / 3) * 3 + col / 3);
+            assert(cell % 9 == TicTacToe::toCell(row % 3, col % 3));
+            assert(UltimateBoard::toMove(cell) == std::make_pair(row, col));
+        }
+    }
+}
+
+void test_forced() {
+    // Box 0,1 of sub-board 0 sends the opponent to sub-board 1
+    UltimateBoard bb;
+    bb.set(0, 1, PLAYER_X_MARK);
+    assert(bb.forced == 1);
+    UltimateBoard::MoveSet actions = getValidActions(bb);
+    assert(actions.size() == 9);
+    for(moveRCPair move : actions) assert(UltimateBoard::toCell(move.row, move.column) / 9 == 1);
+
+    // Once O wins sub-board 1, a move sent there may go to any clear box of the other sub-boards
+    bb.set(0, 3, PLAYER_O_MARK);
+    bb.set(1, 4, PLAYER_O_MARK);
+    bb.set(2, 5, PLAYER_O_MARK);
+    assert(bb.wonO == 1 << 1 && bb.wonX == 0);
+    bb.set(3, 1, PLAYER_X_MARK);
+    assert(bb.forced == ANY_SUBBOARD);
+    actions = getValidActions(bb);
+    assert(actions.size() == 8 * 9 - 2);
+    for(moveRCPair move : actions) assert(UltimateBoard::toCell(move.row, move.column) / 9 != 1);
+
+    // Taking back a box of the won sub-board reopens it
+    bb.clear(2, 5);
+    assert(bb.wonO == 0);
+
+    // Three sub-boards in a row of the meta-board win the game, and a full meta-board without one is a draw
+    UltimateBoard meta;
+    meta.wonX = (1 << 2) | (1 << 4) | (1 << 6);
+    assert(terminalState(meta) == PLAYER_X_WON);
+    assert(getValidActions(meta).empty());
+    meta.wonX = (1 << 0) | (1 << 4);
+    assert(terminalState(meta) == ONGOING);
+    meta.drawn = SUBBOARD_MASK & ~meta.wonX;
+    assert(terminalState(meta) == DRAW);
+}
+
+void test_hash() {
+    // The same boxes with a different sub-board forced are different positions
+    UltimateBoard forcedOne;
+    forcedOne.set(0, 1, PLAYER_X_MARK);
+    UltimateBoard forcedAny = forcedOne;
+    forcedAny.forced = ANY_SUBBOARD;
+    assert(zobristHash(forcedOne, PLAYER_O_CODE) != zobristHash(forcedAny, PLAYER_O_CODE));
+    assert(zobristHash(forcedOne, PLAYER_O_CODE) != zobristHash(forcedOne, PLAYER_X_CODE));
+}
+
+void test_makeMove() {
+    // Play the first, middle, or last valid move in turn until the game ends, then take every move back
+    for(int pattern = 0; pattern < 3; pattern++) {
+        Game<UltimateBoard> game(UltimateBoard(), PLAYER_X_CODE);
+        game.hashSymmetries(true);
+        std::vector<UltimateBoard> states;
+        std::vector<uint64_t> hashes;
+        for(int i = 0; game.result == ONGOING; i++) {
+            states.push_back(game.board.state);
+            hashes.push_back(game.hash());
+            UltimateBoard::MoveSet actions = getValidActions(game.board.state);
+            int pick = ((i + pattern) % 3 == 0) ? 0 : (((i + pattern) % 3 == 1) ? actions.size() / 2 : actions.size() - 1);
+            moveRCPair move = actions.nth(pick);
+            assert(game.makeMove(move.row, move.column) == terminalState(game.board.state));
+            assert(game.hash() == zobristHash(game.board.state, game.currentPlayer));
+            for(int t = 0; t < UltimateBoard::SYMMETRIES; t++) assert(game.boardHashes[t] == zobristBoardHash(transformBoard(game.board.state, t)));
+        }
+        assert(game.turns == (int)states.size());
+
+        while(!states.empty()) {
+            game.undoMove();
+            const UltimateBoard& state = game.board.state;
+            assert(state == states.back());
+            assert(state.wonX == states.back().wonX && state.wonO == states.back().wonO && state.drawn == states.back().drawn);
+            assert(game.result == terminalState(state));
+            assert(game.hash() == hashes.back());
+            states.pop_back();
+            hashes.pop_back();
+        }
+        assert(game.turns == 0 && game.board.state.forced == ANY_SUBBOARD);
+    }
+}
+
+int main(int argc, char** argv) {
+    test_cells();
+    test_forced();
+    test_hash();
+    test_makeMove();
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ *  @file threats.h
+ *  @author Vincent Li
+ *  Finds moves that are forced by the threats on the board, from the marks on each line:
+ *  a win in one, a block of the opponent's win in one, and a fork of two wins in one that can not both be blocked.
+ *  The AI players play these without searching.
+ */
+
+#pragma once
+#ifndef THREATS
+#define THREATS
+
+#include "util.h"
+#include "board.h"
+#include "ultimate.h"
+
+// Kinds of forced moves
+const int THREAT_NONE = 0;
+const int THREAT_ONLY_MOVE = 1; // There is one valid move
+const int THREAT_WIN = 2;       // The move wins
+const int THREAT_BLOCK = 3;     // Every other move lets the opponent win next
+const int THREAT_FORK = 4;      // The move makes two wins in one, and the opponent has none to answer with
+const char* const THREAT_NAMES[] = {"none", "only move", "win", "block", "fork"};
+
+// A forced move and its kind, or THREAT_NONE if the position has to be searched
+struct ForcedMove {
+    moveRCPair move = std::make_pair(-1, -1);
+    int kind = THREAT_NONE;
+};
+
+/**
+ *  Returns the mask of the clear boxes that complete a line for the player with @param mark.
+ */
+template<int R, int C, int K>
+typename BitBoard<R, C, K>::Mask winningCells(const BitBoard<R, C, K>& board, char mark) {
+    typedef BitBoard<R, C, K> Board;
+    typename Board::Mask own = board.marks(mark);
+    typename Board::Mask opp = board.marks((mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK);
+    typename Board::Mask cells = 0;
+    for(typename Board::Mask line : Board::LINES) {
+        if((opp & line) == 0 && countBits(own & line) == K - 1) cells |= line & ~own;
+    }
+    return cells;
+}
+
+/**
+ *  Returns the mask of the clear boxes that give the player with @param mark two or more wins in one at once.
+ *  Only lines through the box can gain a threat, so each box looks at those.
+ *  For the opponent's mark, these are the forks to prevent.
+ */
+template<int R, int C, int K>
+typename BitBoard<R, C, K>::Mask forkCells(const BitBoard<R, C, K>& board, char mark) {
+    typedef BitBoard<R, C, K> Board;
+    typedef typename Board::Mask Mask;
+    Mask own = board.marks(mark);
+    Mask opp = board.marks((mark == PLAYER_X_MARK) ? PLAYER_O_MARK : PLAYER_X_MARK);
+    Mask threats = winningCells(board, mark);
+    Mask forks = 0;
+    for(Mask clear = ~board.occupied() & Board::FULL; clear != 0; clear &= clear - 1) {
+        int cell = lowestBit(clear);
+        Mask bit = Mask(1) << cell;
+        // Wins in one after the move, counted by box, since two lines may meet at one
+        Mask wins = threats & ~bit;
+        const std::array<uint8_t, 4 * K + 1>& lines = Board::CELL_LINES[cell];
+        for(int i = 1; i <= lines[0]; i++) {
+            Mask line = Board::LINES[lines[i]];
+            if((opp & line) == 0 && countBits(own & line) == K - 2) wins |= line & ~own & ~bit;
+        }
+        if(countBits(wins) >= 2) forks |= bit;
+    }
+    return forks;
+}
+
+/**
+ *  Returns the move forced on the player with @param mark, in order: the only move, a win, a block, or a fork.
+ *  If the opponent has two wins in one, the game is lost and it is left to the search.
+ *  The opponent's forks have no single forced answer, so they are left to the search too.
+ */
+template<int R, int C, int K>
+ForcedMove forcedMove(const BitBoard<R, C, K>& board, char mark, char opponentMark) {
+    typedef BitBoard<R, C, K> Board;
+    typedef typename Board::Mask Mask;
+    ForcedMove forced;
+    Mask clear = ~board.occupied() & Board::FULL;
+    Mask wins = winningCells(board, mark);
+    Mask blocks = winningCells(board, opponentMark);
+    Mask forks = 0;
+
+    if(countBits(clear) == 1) forced.kind = THREAT_ONLY_MOVE;
+    else if(wins != 0) forced.kind = THREAT_WIN;
+    else if(countBits(blocks) == 1) forced.kind = THREAT_BLOCK;
+    else if(blocks == 0 && (forks = forkCells(board, mark)) != 0) forced.kind = THREAT_FORK;
+    else return forced;
+
+    Mask cells = (forced.kind == THREAT_ONLY_MOVE) ? clear : ((forced.kind == THREAT_WIN) ? wins : ((forced.kind == THREAT_BLOCK) ? blocks : forks));
+    forced.move = Board::toMove(lowestBit(cells));
+    return forced;
+}
+
+/**
+ *  Returns whether the player with the given won sub-boards can win the meta-board by winning one more.
+ *  @param blocked has the sub-boards won by the opponent or drawn.
+ */
+inline bool hasMetaThreat(uint16_t won, uint16_t blocked) {
+    for(uint16_t line : TicTacToe::LINES) {
+        if((blocked & line) == 0 && countBits(won & line) == 2) return true;
+    }
+    return false;
+}
+
+/**
+ *  Returns the move forced on the player with @param mark in Ultimate Tic Tac Toe: the only move, a win, or a block.
+ *  A win must win a sub-board on a line of the meta-board, so the moves are only tried if the meta-board has such a line.
+ *  A block is the one move after which the opponent can not win at once, wherever it is sent.
+ */
+inline ForcedMove forcedMove(const UltimateBoard& board, char mark, char opponentMark) {
+    ForcedMove forced;
+    UltimateBoard::MoveSet validActions = getValidActions(board);
+    if(validActions.size() == 1) {
+        forced.move = validActions.nth(0);
+        forced.kind = THREAT_ONLY_MOVE;
+        return forced;
+    }
+
+    bool isX = (mark == PLAYER_X_MARK);
+    uint16_t ownWon = isX ? board.wonX : board.wonO;
+    uint16_t oppWon = isX ? board.wonO : board.wonX;
+    int ownCode = isX ? PLAYER_X_WON : PLAYER_O_WON;
+    if(hasMetaThreat(ownWon, oppWon | board.drawn)) {
+        for(moveRCPair move : validActions) {
+            UltimateBoard next = board;
+            next.set(move.row, move.column, mark);
+            if(terminalState(next) == ownCode) {
+                forced.move = move;
+                forced.kind = THREAT_WIN;
+                return forced;
+            }
+        }
+    }
+
+    if(!hasMetaThreat(oppWon, ownWon | board.drawn)) return forced;
+    int safeMoves = 0;
+    moveRCPair safe;
+    for(moveRCPair move : validActions) {
+        UltimateBoard next = board;
+        next.set(move.row, move.column, mark);
+        bool lost = false;
+        if(terminalState(next) == ONGOING) {
+            for(moveRCPair reply : getValidActions(next)) {
+                UltimateBoard after = next;
+                after.set(reply.row, reply.column, opponentMark);
+                if(terminalState(after) == -1 * ownCode) {
+                    lost = true;
+                    break;
+                }
+            }
+        }
+        if(!lost && ++safeMoves > 1) return forced;
+        if(!lost) safe = move;
+    }
+    if(safeMoves == 1) {
+        forced.move = safe;
+        forced.kind = THREAT_BLOCK;
+    }
+    return forced;
+}
+
+#endif  // THREATS
@@ -0,0 +1,51 @@
+/**
+ *  @file transposition.cpp
+ *  @author Vincent Li
+ */
+
+#include "transposition.h"
+
+/**
+ *  Returns the fields of the entry besides the key packed in one word.
+ */
+static uint64_t pack(int value, int depth, uint8_t bound, moveRCPair move) {
+    return (uint64_t)(uint16_t)value | ((uint64_t)(uint8_t)depth << 16) | ((uint64_t)bound << 24)
+            | ((uint64_t)(uint8_t)move.row << 32) | ((uint64_t)(uint8_t)move.column << 40);
+}
+
+TranspositionTable::TranspositionTable(int sizeLog2) {
+    slots.reset(new Slot[(size_t)1 << sizeLog2]);
+    indexMask = ((uint64_t)1 << sizeLog2) - 1;
+    clear();
+}
+
+bool TranspositionTable::probe(uint64_t key, TableEntry& entry) const {
+    const Slot& slot = slots[key & indexMask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if((check ^ data) != key) return false;
+
+    entry.key = key;
+    entry.value = (int16_t)(data & 0xFFFF);
+    entry.depth = (int8_t)((data >> 16) & 0xFF);
+    entry.bound = (uint8_t)((data >> 24) & 0xFF);
+    entry.moveRow = (int8_t)((data >> 32) & 0xFF);
+    entry.moveCol = (int8_t)((data >> 40) & 0xFF);
+    return entry.depth >= 0;
+}
+
+void TranspositionTable::store(uint64_t key, int value, int depth, uint8_t bound, moveRCPair move) {
+    Slot& slot = slots[key & indexMask];
+    uint64_t data = pack(value, depth, bound, move);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    // Empty slots have a depth of -1, so they never match, even a key of 0
+    uint64_t empty = pack(0, -1, EXACT_BOUND, std::make_pair(-1, -1));
+    for(uint64_t i = 0; i <= indexMask; i++) {
+        slots[i].check.store(empty, std::memory_order_relaxed);
+        slots[i].data.store(empty, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ *  @file transposition.h
+ *  @author Vincent Li
+ *  A fixed-size transposition table of search results, indexed by Zobrist hash.
+ *  Positions reached through a different order of moves are looked up instead of searched again.
+ *  Threads may probe and store at once.  Each slot is two atomic words, the entry and the hash XOR the entry,
+ *  so a slot torn by two stores no longer matches either hash and reads as empty.
+ */
+
+#pragma once
+#ifndef TRANSPOSITION
+#define TRANSPOSITION
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+#include "util.h"
+
+// Kinds of values stored in the table
+const uint8_t EXACT_BOUND = 0;  // The value is exact
+const uint8_t LOWER_BOUND = 1;  // The search failed high, so the value is at least this
+const uint8_t UPPER_BOUND = 2;  // The search failed low, so the value is at most this
+
+struct TableEntry {
+    uint64_t key = 0;       // Full hash of the position, to tell apart positions in the same slot
+    int16_t value = 0;      // The value found by the search
+    int8_t depth = -1;      // The remaining depth of the search, or -1 if the slot is empty
+    uint8_t bound = EXACT_BOUND;
+    int8_t moveRow = -1;    // The best move found, or -1 if there is none
+    int8_t moveCol = -1;
+};
+
+class TranspositionTable {
+    public:
+        /**
+         *  Constructor
+         *  The table holds 2^@param sizeLog2 entries.
+         */
+        TranspositionTable(int sizeLog2 = 18);
+
+        /**
+         *  Copy the entry of the position with the given hash into @param entry.
+         *  Returns false if it is not stored.
+         */
+        bool probe(uint64_t key, TableEntry& entry) const;
+
+        /**
+         *  Store a search result, replacing whatever was in the position's slot.
+         */
+        void store(uint64_t key, int value, int depth, uint8_t bound, moveRCPair move);
+
+        /**
+         *  Empty every slot.  No thread may be searching.
+         */
+        void clear();
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> check;    // The key XOR data
+            std::atomic<uint64_t> data;     // The fields of the entry besides the key, packed
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        uint64_t indexMask;
+};
+
+#endif  // TRANSPOSITION
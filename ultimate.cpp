@@ -0,0 +1,45 @@
+/**
+ *  @file ultimate.cpp
+ *  @author Vincent Li
+ */
+
+#include <sstream>
+#include "ultimate.h"
+
+template<>
+std::string GameBoard<UltimateBoard>::visBoard() {
+    std::stringstream ss;
+    ss << " ";
+    for(int c = 0; c < UltimateBoard::COLS; c++) ss << ((c % 3 == 0 && c > 0) ? "   " : "  ") << c;
+    ss << "\n";
+    for(int r = 0; r < UltimateBoard::ROWS; r++) {
+        if(r % 3 == 0 && r > 0) ss << "\n";
+        ss << r << " ";
+        for(int c = 0; c < UltimateBoard::COLS; c++) {
+            if(c % 3 == 0 && c > 0) ss << " ";
+            ss << "[" << state.get(r, c) << "]";
+        }
+        ss << "\n";
+    }
+
+    // The meta-board, where D is a drawn sub-board
+    ss << "Sub-boards:\n";
+    for(int r = 0; r < 3; r++) {
+        ss << "  ";
+        for(int c = 0; c < 3; c++) {
+            uint16_t bit = 1 << (r * 3 + c);
+            char mark = (state.wonX & bit) ? PLAYER_X_MARK : ((state.wonO & bit) ? PLAYER_O_MARK : ((state.drawn & bit) ? 'D' : CLEAR));
+            ss << "[" << mark << "]";
+        }
+        ss << "\n";
+    }
+    if(state.forced == ANY_SUBBOARD) ss << "Next move: any open sub-board\n";
+    else ss << "Next move: sub-board at rows " << (state.forced / 3) * 3 << "-" << (state.forced / 3) * 3 + 2
+            << ", cols " << (state.forced % 3) * 3 << "-" << (state.forced % 3) * 3 + 2 << "\n";
+
+    std::string display;
+
+    display = ss.str();
+
+    return display;
+}
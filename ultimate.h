@@ -0,0 +1,220 @@
+/**
+ *  @file ultimate.h
+ *  @author Vincent Li
+ *  Implements the board of Ultimate Tic Tac Toe: a 3x3 meta-board of 3x3 sub-boards.
+ *  The box marked in a sub-board sends the opponent to the sub-board in the same position.
+ *  Winning a sub-board claims its box of the meta-board, and three claimed boxes in a row win the game.
+ */
+
+#pragma once
+#ifndef ULTIMATE
+#define ULTIMATE
+
+#include <stdint.h>
+#include <string>
+
+#include "board.h"
+#include "game.h"
+#include "symmetry.h"
+
+// Value of UltimateBoard::forced when the next move may be in any open sub-board.
+const int ANY_SUBBOARD = -1;
+
+// Mask of the boxes of one sub-board, or of the meta-board.
+const uint16_t SUBBOARD_MASK = 0777;
+
+struct UltimateTracker;
+
+/**
+ *  A game state of Ultimate Tic Tac Toe packed into one 81-bit mask per player plus the meta-board.
+ *  The boxes of sub-board s are bits 9s to 9s + 8, in the same order as a TicTacToe board,
+ *  so every sub-board is looked up in TERMINAL_TABLE with a shift and a mask.
+ */
+struct UltimateBoard {
+    static constexpr int ROWS = 9;
+    static constexpr int COLS = 9;
+    static constexpr int CELLS = 81;
+    // Rotations and reflections of the whole grid, which turn the sub-boards and the meta-board alike.
+    static constexpr int SYMMETRIES = 8;
+
+    typedef unsigned __int128 Mask;
+    typedef MaskMoveSet<UltimateBoard> MoveSet;   // Set of moves returned by getValidActions()
+    typedef UltimateTracker Tracker;              // Incremental state kept by Game for makeMove/undoMove
+
+    Mask x = 0;  // Boxes marked by Player X
+    Mask o = 0;  // Boxes marked by Player O
+
+    uint16_t wonX = 0;   // Sub-boards won by Player X
+    uint16_t wonO = 0;   // Sub-boards won by Player O
+    uint16_t drawn = 0;  // Sub-boards filled without a winner
+
+    int8_t forced = ANY_SUBBOARD;  // Sub-board the next move must be in, or ANY_SUBBOARD
+
+    // Returns the bit index of the box in the given row and col of the 9x9 grid.
+    static constexpr int toCell(int row, int col) { return ((row / 3) * 3 + col / 3) * 9 + (row % 3) * 3 + col % 3; }
+
+    // Returns the row and col in the 9x9 grid of the box with the given bit index.
+    static constexpr moveRCPair toMove(int cell) {
+        int sub = cell / 9;
+        int box = cell % 9;
+        return std::make_pair((sub / 3) * 3 + box / 3, (sub % 3) * 3 + box % 3);
+    }
+
+    // Returns the 9-bit mask of sub-board s from the given 81-bit mask.
+    static uint16_t subBoard(Mask marks, int s) { return uint16_t(marks >> (9 * s)) & SUBBOARD_MASK; }
+
+    // Returns the mask of the sub-boards that are won or drawn.
+    uint16_t decided() const { return wonX | wonO | drawn; }
+
+    // Returns the mask of the boxes with the given mark.
+    Mask marks(char mark) const { return (mark == PLAYER_X_MARK) ? x : o; }
+
+    // Returns the mask of the boxes that are marked by either player.
+    Mask occupied() const { return x | o; }
+
+    // Returns the mark in the given row and col, or CLEAR.
+    char get(int row, int col) const {
+        Mask bit = Mask(1) << toCell(row, col);
+        return (x & bit) ? PLAYER_X_MARK : ((o & bit) ? PLAYER_O_MARK : CLEAR);
+    }
+
+    // Look up sub-board s and record on the meta-board whether it is won or drawn.
+    void updateSubBoard(int s) {
+        uint16_t bit = 1 << s;
+        wonX &= ~bit;
+        wonO &= ~bit;
+        drawn &= ~bit;
+
+        int result = TERMINAL_TABLE.result[ternaryIndex(subBoard(x, s), subBoard(o, s))];
+        if(result == PLAYER_X_WON) wonX |= bit;
+        else if(result == PLAYER_O_WON) wonO |= bit;
+        else if(result == DRAW) drawn |= bit;
+    }
+
+    /**
+     *  Marks the box in the given row and col.  Does not check if the move is allowed.
+     *  Updates the meta-board and sends the opponent to the matching sub-board, or anywhere if it is decided.
+     */
+    void set(int row, int col, char mark) {
+        int cell = toCell(row, col);
+        if(mark == PLAYER_X_MARK) x |= Mask(1) << cell;
+        else o |= Mask(1) << cell;
+
+        updateSubBoard(cell / 9);
+        forced = (decided() & (1 << (cell % 9))) ? ANY_SUBBOARD : cell % 9;
+    }
+
+    /**
+     *  Clears the box in the given row and col and updates the meta-board.
+     *  forced is left as is, since it depends on the move before.  UltimateTracker restores it.
+     */
+    void clear(int row, int col) {
+        int cell = toCell(row, col);
+        x &= ~(Mask(1) << cell);
+        o &= ~(Mask(1) << cell);
+
+        updateSubBoard(cell / 9);
+    }
+
+    bool operator==(const UltimateBoard& other) const {
+        return x == other.x && o == other.o && forced == other.forced;
+    }
+    bool operator!=(const UltimateBoard& other) const { return !(*this == other); }
+};
+
+/**
+ *  Determine whether the game is won by Player X/O, a draw, or still being played.
+ *  The meta-board is looked up in TERMINAL_TABLE.  A game with every sub-board decided and no line is a draw.
+ *  Return PLAYER_X_WON, PLAYER_O_WON, DRAW, or ONGOING.
+ */
+inline int terminalState(const UltimateBoard& board) {
+    int result = TERMINAL_TABLE.result[ternaryIndex(board.wonX, board.wonO)];
+    if(result != PLAYER_X_WON && result != PLAYER_O_WON) {
+        result = (board.decided() == SUBBOARD_MASK) ? DRAW : ONGOING;
+    }
+
+    return result;
+}
+
+/**
+ *  Get the set of valid actions: the clear boxes of the forced sub-board,
+ *  or of every sub-board that is not decided yet.  A finished game has none.
+ */
+inline UltimateBoard::MoveSet getValidActions(const UltimateBoard& gameState) {
+    UltimateBoard::MoveSet actions;
+    UltimateBoard::Mask clear = ~gameState.occupied();
+
+    if(terminalState(gameState) != ONGOING) {
+        // No moves after the meta-board is decided
+    }
+    else if(gameState.forced != ANY_SUBBOARD) {
+        actions.cells = clear & (UltimateBoard::Mask(SUBBOARD_MASK) << (9 * gameState.forced));
+    }
+    else {
+        uint16_t open = ~gameState.decided() & SUBBOARD_MASK;
+        for(; open != 0; open &= open - 1) {
+            actions.cells |= clear & (UltimateBoard::Mask(SUBBOARD_MASK) << (9 * lowestBit(open)));
+        }
+    }
+
+    return actions;
+}
+
+/**
+ *  Returns the Zobrist key of the forced sub-board, which the boxes alone do not tell, under the given symmetry.
+ */
+inline uint64_t zobristExtra(const UltimateBoard& board, int symmetry = 0) {
+    int forced = (board.forced == ANY_SUBBOARD) ? ANY_SUBBOARD : SYMMETRY_TABLE<TicTacToe>.cells[symmetry][board.forced];
+    return ZOBRIST_KEYS.extra[forced + 1];
+}
+
+/**
+ *  Returns the game state under symmetry t.
+ *  A symmetry of the grid moves the sub-boards like the boxes of a TicTacToe board, so the meta-board uses its table.
+ */
+inline UltimateBoard transformBoard(const UltimateBoard& board, int t) {
+    UltimateBoard image;
+    image.x = transformMask<UltimateBoard>(board.x, t);
+    image.o = transformMask<UltimateBoard>(board.o, t);
+    image.wonX = transformMask<TicTacToe>(board.wonX, t);
+    image.wonO = transformMask<TicTacToe>(board.wonO, t);
+    image.drawn = transformMask<TicTacToe>(board.drawn, t);
+    image.forced = (board.forced == ANY_SUBBOARD) ? ANY_SUBBOARD : SYMMETRY_TABLE<TicTacToe>.cells[t][board.forced];
+    return image;
+}
+
+/**
+ *  Keeps the forced sub-board of each move so Game can take moves back.
+ *  Everything else about a move is looked up from the packed state.
+ */
+struct UltimateTracker {
+    int8_t forcedHistory[UltimateBoard::CELLS];  // forced before each move
+    int moves = 0;
+
+    void reset(const UltimateBoard& state) { moves = 0; }
+
+    // Mark the box and return the game result, which is looked up from the meta-board.
+    int add(UltimateBoard& state, int row, int col, char mark, int result) {
+        forcedHistory[moves++] = state.forced;
+        state.set(row, col, mark);
+
+        return terminalState(state);
+    }
+
+    // Clear the box and restore the sub-board the move was forced into.
+    void remove(UltimateBoard& state, int row, int col, char mark) {
+        state.clear(row, col);
+        state.forced = forcedHistory[--moves];
+    }
+};
+
+template<> std::string GameBoard<UltimateBoard>::visBoard();
+
+/**
+ *  Calls MACRO with each board type that the templates are instantiated for, including Ultimate Tic Tac Toe.
+ */
+#define FOR_EACH_GAME(MACRO) \
+    FOR_EACH_BOARD(MACRO) \
+    MACRO(UltimateBoard)
+
+#endif  // ULTIMATE
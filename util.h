@@ -8,6 +8,7 @@
 #ifndef UTIL
 #define UTIL
 
+#include <stdint.h>
 #include <string>
 
 #define row first
@@ -27,17 +28,28 @@ const char PLAYER_O_MARK = 'O';
 // Placeholder for an empty box in the board
 const char CLEAR = '_';
 
-// Blank board
-#define BLANK_BOARD {{CLEAR, CLEAR, CLEAR}, {CLEAR, CLEAR, CLEAR}, {CLEAR, CLEAR, CLEAR}}
-
-const int ROWS = 3;
-
-const int COLS = 3;
-
 const int PLAYER_O_WON = PLAYER_O_CODE;
 const int PLAYER_X_WON = PLAYER_X_CODE;
 const int WIN = 1;
 const int LOSS = -1;
 const int DRAW = 0;
+const int ONGOING = 2;
+
+// Returns the mark of the player with the given code.
+inline char codeToMark(int code) { return (code == PLAYER_X_CODE) ? PLAYER_X_MARK : PLAYER_O_MARK; }
+
+// Returns the number of set bits of a board mask.  Masks may be up to 128 bits.
+template<typename Mask>
+inline int countBits(Mask mask) {
+    if constexpr(sizeof(Mask) > 8) return __builtin_popcountll((uint64_t)mask) + __builtin_popcountll((uint64_t)(mask >> 64));
+    else return __builtin_popcountll(mask);
+}
+
+// Returns the index of the lowest set bit of a nonzero board mask.  Masks may be up to 128 bits.
+template<typename Mask>
+inline int lowestBit(Mask mask) {
+    if constexpr(sizeof(Mask) > 8) return ((uint64_t)mask != 0) ? __builtin_ctzll((uint64_t)mask) : 64 + __builtin_ctzll((uint64_t)(mask >> 64));
+    else return __builtin_ctzll(mask);
+}
 
 #endif  // UTIL
\ No newline at end of file
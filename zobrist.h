@@ -0,0 +1,84 @@
+/**
+ *  @file zobrist.h
+ *  @author Vincent Li
+ *  Zobrist hashing of game states.
+ *  A state's hash is the XOR of a random key for each marked box, one for Player O to move,
+ *  and one for any other state of the board, so a move updates it with a couple of XORs.
+ */
+
+#pragma once
+#ifndef ZOBRIST
+#define ZOBRIST
+
+#include <stdint.h>
+
+#include "util.h"
+#include "board.h"
+#include "prng.h"
+
+// Most boxes of any board that can be hashed.
+const int ZOBRIST_CELLS = 128;
+// Number of keys for state other than the boxes, like the forced sub-board of Ultimate Tic Tac Toe.
+const int ZOBRIST_EXTRA = 16;
+
+struct ZobristKeys {
+    uint64_t cells[2][ZOBRIST_CELLS];  // Keys for an X (index 0) or O (index 1) in each box
+    uint64_t side;                     // Key for Player O to move
+    uint64_t extra[ZOBRIST_EXTRA];     // Keys for other state of the board
+};
+
+/**
+ *  Build the keys at compile time from a fixed seed, so hashes are the same in every run.
+ */
+constexpr ZobristKeys createZobristKeys() {
+    ZobristKeys keys = {};
+    uint64_t state = 0x5eed;
+
+    for(int side = 0; side < 2; side++) {
+        for(int cell = 0; cell < ZOBRIST_CELLS; cell++) keys.cells[side][cell] = splitMix64(state);
+    }
+    keys.side = splitMix64(state);
+    for(int i = 0; i < ZOBRIST_EXTRA; i++) keys.extra[i] = splitMix64(state);
+
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST_KEYS = createZobristKeys();
+
+/**
+ *  Returns the key of the given mark in the box with the given bit index.
+ */
+inline uint64_t zobristKey(char mark, int cell) {
+    return ZOBRIST_KEYS.cells[(mark == PLAYER_X_MARK) ? 0 : 1][cell];
+}
+
+/**
+ *  Returns the key of the state of the board other than its boxes, under the given symmetry.  Bitboards have none.
+ */
+template<int R, int C, int K>
+inline uint64_t zobristExtra(const BitBoard<R, C, K>& board, int symmetry = 0) {
+    return 0;
+}
+
+/**
+ *  Returns the hash of the given game state without the player to move.
+ */
+template<class Board>
+uint64_t zobristBoardHash(const Board& state) {
+    uint64_t hash = 0;
+
+    for(typename Board::Mask x = state.x; x != 0; x &= x - 1) hash ^= zobristKey(PLAYER_X_MARK, lowestBit(x));
+    for(typename Board::Mask o = state.o; o != 0; o &= o - 1) hash ^= zobristKey(PLAYER_O_MARK, lowestBit(o));
+
+    return hash ^ zobristExtra(state);
+}
+
+/**
+ *  Returns the hash of the given game state with the player of the given code to move.
+ */
+template<class Board>
+uint64_t zobristHash(const Board& state, int currentPlayer) {
+    return zobristBoardHash(state) ^ ((currentPlayer == PLAYER_O_CODE) ? ZOBRIST_KEYS.side : 0);
+}
+
+#endif  // ZOBRIST